@@ -24,11 +24,13 @@ void block_init(block *b, objectfunction *func, instructionindx start) {
     b->func=func;
     b->isentry=false;
     b->isloopheader=false;
+    b->raises=false;
     b->branch=BLOCKINDX_EMPTY;
     b->fallthrough=BLOCKINDX_EMPTY;
     
     reginfolist_init(&b->rin, func->nregs);
     reginfolist_init(&b->rout, func->nregs);
+    reginfolist_init(&b->rexc, func->nregs);
     
     dictionary_init(&b->src);
     dictionary_init(&b->dest);
@@ -36,12 +38,15 @@ void block_init(block *b, objectfunction *func, instructionindx start) {
     dictionary_init(&b->writes);
     dictionary_init(&b->loopsrc);
     dictionary_init(&b->loopblocks);
+    dictionary_init(&b->handlers);
+    dictionary_init(&b->region);
 }
 
 /** Clears a basic block structure */
 void block_clear(block *b) {
     reginfolist_clear(&b->rin);
     reginfolist_clear(&b->rout);
+    reginfolist_clear(&b->rexc);
     
     dictionary_clear(&b->src);
     dictionary_clear(&b->uses);
@@ -49,6 +54,8 @@ void block_clear(block *b) {
     dictionary_clear(&b->writes);
     dictionary_clear(&b->loopsrc);
     dictionary_clear(&b->loopblocks);
+    dictionary_clear(&b->handlers);
+    dictionary_clear(&b->region);
 }
 
 /* --------------
@@ -152,6 +159,35 @@ bool block_inloop(block *b, blockindx indx) {
     return dictionary_get(&b->loopblocks, MORPHO_INTEGER((int) indx), NULL);
 }
 
+/** Clears the handler blocks recorded for a block, and the try region it handles. */
+void block_clearhandlers(block *b) {
+    dictionary_clear(&b->handlers);
+    dictionary_init(&b->handlers);
+    dictionary_clear(&b->region);
+    dictionary_init(&b->region);
+    b->raises=false;
+}
+
+/** Records a handler block that receives errors raised within this block. */
+void block_sethandler(block *b, blockindx indx) {
+    dictionary_insert(&b->handlers, MORPHO_INTEGER((int) indx), MORPHO_NIL);
+}
+
+/** Determines if errors raised within a block may reach a given handler block. */
+bool block_hashandler(block *b, blockindx indx) {
+    return dictionary_get(&b->handlers, MORPHO_INTEGER((int) indx), NULL);
+}
+
+/** Determines if a block lies within a try region. */
+bool block_hashandlers(block *b) {
+    return b->handlers.count>0;
+}
+
+/** Records a block that lies within a try region handled by this block. */
+void block_setregionblock(block *b, blockindx indx) {
+    dictionary_insert(&b->region, MORPHO_INTEGER((int) indx), MORPHO_NIL);
+}
+
 bool cfgraph_connect(block *src, blockindx dst, instructionindx dststart, cfgraph *graph) {
     block *dest;
 
@@ -34,14 +34,18 @@ typedef struct sblock {
     dictionary writes; /** Registers that the block writes to */
     dictionary loopsrc; /** Structural back-edge predecessors for loop headers */
     dictionary loopblocks; /** Blocks that participate in the loop headed here */
+    dictionary handlers; /** Handler blocks that receive errors raised within this block */
+    dictionary region; /** Blocks within the try regions handled by this block */
     
     objectfunction *func; /** Function that encapsulates the block */
     
     bool isentry; /** Is this the entry point for the function */
     bool isloopheader; /** Is this block a structural loop header candidate */
+    bool raises; /** Does the block contain an instruction that may raise to one of its handlers */
     
     reginfolist rin; /** Contents of registers on entry */
     reginfolist rout; /** Contents of registers on exit */
+    reginfolist rexc; /** Contents of registers joined over the instructions that may raise */
 } block;
 
 /* **********************************************************************
@@ -74,6 +78,11 @@ void block_setloopsource(block *b, blockindx indx);
 void block_setloopblock(block *b, blockindx indx);
 bool block_isloopheader(block *b);
 bool block_inloop(block *b, blockindx indx);
+void block_clearhandlers(block *b);
+void block_sethandler(block *b, blockindx indx);
+bool block_hashandler(block *b, blockindx indx);
+bool block_hashandlers(block *b);
+void block_setregionblock(block *b, blockindx indx);
 bool cfgraph_connect(block *src, blockindx dst, instructionindx dststart, cfgraph *graph);
 bool cfgraph_disconnect(block *src, blockindx dst, cfgraph *graph);
 
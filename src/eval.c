@@ -4,6 +4,10 @@
  *  @brief Evaluate subprograms
 */
 
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
 #include "morphocore.h"
 #include "optimize.h"
 #include "eval.h"
@@ -40,3 +44,136 @@ bool optimize_evalsubprogram(optimizer *opt, instruction *list, registerindx des
     
     return success;
 }
+
+/* **********************************************************************
+ * Native folding
+ * ********************************************************************** */
+
+/** Int arithmetic and comparison; results that overflow, and Int division and powers, are left to the VM */
+static bool _evalinteger(instruction op, int a, int b, value *out) {
+    int r;
+    
+    switch (op) {
+        case OP_ADD: if (__builtin_add_overflow(a, b, &r)) return false; break;
+        case OP_SUB: if (__builtin_sub_overflow(a, b, &r)) return false; break;
+        case OP_MUL: if (__builtin_mul_overflow(a, b, &r)) return false; break;
+        case OP_EQ: *out = MORPHO_BOOL(a==b); return true;
+        case OP_NEQ: *out = MORPHO_BOOL(a!=b); return true;
+        case OP_LT: *out = MORPHO_BOOL(a<b); return true;
+        case OP_LE: *out = MORPHO_BOOL(a<=b); return true;
+        default: return false;
+    }
+    
+    *out = MORPHO_INTEGER(r);
+    return true;
+}
+
+/** Float arithmetic and comparison, with any Int operand promoted */
+static bool _evalfloat(instruction op, double a, double b, value *out) {
+    switch (op) {
+        case OP_ADD: *out = MORPHO_FLOAT(a+b); return true;
+        case OP_SUB: *out = MORPHO_FLOAT(a-b); return true;
+        case OP_MUL: *out = MORPHO_FLOAT(a*b); return true;
+        case OP_DIV:
+            if (b==0.0) return false; // Let the VM decide how to divide by zero
+            *out = MORPHO_FLOAT(a/b); return true;
+        case OP_POW:
+            if (a<0.0 && b!=floor(b)) return false; // Fractional powers of negative numbers aren't real
+            *out = MORPHO_FLOAT(pow(a, b)); return true;
+        case OP_EQ: *out = MORPHO_BOOL(a==b); return true;
+        case OP_NEQ: *out = MORPHO_BOOL(a!=b); return true;
+        case OP_LT: *out = MORPHO_BOOL(a<b); return true;
+        case OP_LE: *out = MORPHO_BOOL(a<=b); return true;
+        default: return false;
+    }
+}
+
+static bool _evalstringequal(value a, value b) {
+    objectstring *sa = MORPHO_GETSTRING(a), *sb = MORPHO_GETSTRING(b);
+    return (sa->length==sb->length && memcmp(sa->string, sb->string, sa->length)==0);
+}
+
+/** String concatenation and equality */
+static bool _evalstring(instruction op, value a, value b, value *out) {
+    switch (op) {
+        case OP_ADD: *out = object_concatenatestring(a, b); return !MORPHO_ISNIL(*out);
+        case OP_EQ: *out = MORPHO_BOOL(_evalstringequal(a, b)); return true;
+        case OP_NEQ: *out = MORPHO_BOOL(!_evalstringequal(a, b)); return true;
+        default: return false;
+    }
+}
+
+static bool _evalnumber(value v, double *out) {
+    if (MORPHO_ISINTEGER(v)) *out = (double) MORPHO_GETINTEGERVALUE(v);
+    else if (MORPHO_ISFLOAT(v)) *out = MORPHO_GETFLOATVALUE(v);
+    else return false;
+    return true;
+}
+
+/** Evaluates an arithmetic or comparison instruction, or not, on constant operands without entering the VM
+    @param[in] op - opcode to evaluate; not uses only left
+    @param[in] left - first operand
+    @param[in] right - second operand
+    @param[out] out - result of evaluation
+    @returns true if the operation was folded; cases this doesn't cover should use optimize_evalsubprogram */
+bool optimize_evalnative(instruction op, value left, value right, value *out) {
+    double a, b;
+    
+    if (op==OP_NOT) {
+        if (!MORPHO_ISBOOL(left)) return false;
+        *out = MORPHO_BOOL(!MORPHO_GETBOOLVALUE(left));
+        return true;
+    }
+    
+    if (MORPHO_ISINTEGER(left) && MORPHO_ISINTEGER(right)) {
+        return _evalinteger(op, MORPHO_GETINTEGERVALUE(left), MORPHO_GETINTEGERVALUE(right), out);
+    }
+    
+    if (MORPHO_ISSTRING(left) && MORPHO_ISSTRING(right)) return _evalstring(op, left, right, out);
+    
+    if (MORPHO_ISBOOL(left) && MORPHO_ISBOOL(right) && (op==OP_EQ || op==OP_NEQ)) {
+        bool equal = (MORPHO_GETBOOLVALUE(left)==MORPHO_GETBOOLVALUE(right));
+        *out = MORPHO_BOOL(op==OP_EQ ? equal : !equal);
+        return true;
+    }
+    
+    if (!_evalnumber(left, &a) || !_evalnumber(right, &b)) return false;
+    
+    // Equality between an Int and a Float follows the VM
+    if ((op==OP_EQ || op==OP_NEQ) && !(MORPHO_ISFLOAT(left) && MORPHO_ISFLOAT(right))) return false;
+    
+    return _evalfloat(op, a, b, out);
+}
+
+/** Concatenates constant Strings and Ints as cat does
+    @param[in] n - number of operands
+    @param[in] operands - the operands
+    @param[out] out - the resulting String
+    @returns true if every operand could be converted */
+bool optimize_evalcat(int n, value *operands, value *out) {
+    size_t length=0;
+    
+    for (int i=0; i<n; i++) {
+        if (MORPHO_ISSTRING(operands[i])) length+=MORPHO_GETSTRING(operands[i])->length;
+        else if (MORPHO_ISINTEGER(operands[i])) length+=snprintf(NULL, 0, "%i", MORPHO_GETINTEGERVALUE(operands[i]));
+        else return false; // Other values are formatted by the VM
+    }
+    
+    char *buffer = MORPHO_MALLOC(length+1);
+    if (!buffer) return false;
+    
+    size_t k=0;
+    for (int i=0; i<n; i++) {
+        if (MORPHO_ISSTRING(operands[i])) {
+            objectstring *str = MORPHO_GETSTRING(operands[i]);
+            memcpy(buffer+k, str->string, str->length);
+            k+=str->length;
+        } else k+=snprintf(buffer+k, length+1-k, "%i", MORPHO_GETINTEGERVALUE(operands[i]));
+    }
+    buffer[length]='\0';
+    
+    *out = object_stringfromcstring(buffer, length);
+    MORPHO_FREE(buffer);
+    
+    return !MORPHO_ISNIL(*out);
+}
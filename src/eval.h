@@ -13,4 +13,10 @@
 /** Evaluates a program given as a raw instruction list */
 bool optimize_evalsubprogram(optimizer *opt, instruction *list, registerindx dest, value *out);
 
+/** Folds arithmetic, comparisons and not on constants in process */
+bool optimize_evalnative(instruction op, value left, value right, value *out);
+
+/** Folds cat of constant Strings and Ints in process */
+bool optimize_evalcat(int n, value *operands, value *out);
+
 #endif
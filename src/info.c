@@ -7,6 +7,7 @@
 #include "info.h"
 
 DEFINE_VARRAY(functioninfoentry, functioninfoentry)
+DEFINE_VARRAY(classnode, classnode)
 /* **********************************************************************
  * Globals
  * ********************************************************************** */
@@ -219,6 +220,158 @@ int classinfolist_countconstructed(classinfolist *clist, objectclass *klass) {
     return 0;
 }
 
+/* **********************************************************************
+ * Class hierarchy
+ * ********************************************************************** */
+
+/** Initializes a class hierarchy index; classes are added as they are queried */
+void classhierarchy_init(classhierarchy *h) {
+    varray_classnodeinit(&h->nodes);
+    dictionary_init(&h->indx);
+}
+
+/** Clears a class hierarchy index. */
+void classhierarchy_clear(classhierarchy *h) {
+    for (int i=0; i<h->nodes.count; i++) dictionary_clear(&h->nodes.data[i].ancestors);
+    varray_classnodeclear(&h->nodes);
+    dictionary_clear(&h->indx);
+}
+
+/** Numbers a class and its subclasses in preorder; returns false if the subtree isn't a tree */
+static bool _classhierarchy_visit(classhierarchy *h, objectclass *klass) {
+    value key = MORPHO_OBJECT(klass);
+    if (dictionary_get(&h->indx, key, NULL)) return false; // Already reached through another parent
+
+    classnode node = { .klass = klass, .last = 0, .istree = true };
+    dictionary_init(&node.ancestors);
+    int i = varray_classnodewrite(&h->nodes, node);
+    dictionary_insert(&h->indx, key, MORPHO_INTEGER(i));
+
+    bool istree=true;
+    for (unsigned int j=0; j<klass->children.count; j++) {
+        value child = klass->children.data[j];
+        if (MORPHO_ISCLASS(child) && !_classhierarchy_visit(h, MORPHO_GETCLASS(child))) istree=false;
+    }
+
+    h->nodes.data[i].last = h->nodes.count-1;
+    h->nodes.data[i].istree = istree;
+    return istree;
+}
+
+/** Finds the preorder number of a class, indexing the hierarchies of its roots on first use */
+static int _classhierarchy_find(classhierarchy *h, objectclass *klass) {
+    value key = MORPHO_OBJECT(klass), i;
+
+    if (!dictionary_get(&h->indx, key, &i)) {
+        for (int j=0; j<klass->linearization.count; j++) {
+            value parent = klass->linearization.data[j];
+            if (MORPHO_ISCLASS(parent) &&
+                MORPHO_GETCLASS(parent)->linearization.count<=1) _classhierarchy_visit(h, MORPHO_GETCLASS(parent));
+        }
+        if (!dictionary_get(&h->indx, key, &i)) {
+            _classhierarchy_visit(h, klass);
+            dictionary_get(&h->indx, key, &i);
+        }
+    }
+
+    return MORPHO_GETINTEGERVALUE(i);
+}
+
+/** Finds the preorder range of the subclasses of a class; fails if a subclass is missing from the range */
+bool classhierarchy_subtree(classhierarchy *h, objectclass *klass, int *first, int *last) {
+    int i = _classhierarchy_find(h, klass);
+    classnode *node = &h->nodes.data[i];
+
+    if (!node->istree) return false;
+    *first = i;
+    *last = node->last;
+    return true;
+}
+
+/** Returns the class with a given preorder number */
+objectclass *classhierarchy_class(classhierarchy *h, int i) {
+    return h->nodes.data[i].klass;
+}
+
+static bool _classhierarchy_walkderivedfrom(objectclass *klass, objectclass *base) {
+    if (klass==base) return true;
+
+    for (unsigned int i=0; i<base->children.count; i++) {
+        value child = base->children.data[i];
+        if (MORPHO_ISCLASS(child) &&
+            _classhierarchy_walkderivedfrom(klass, MORPHO_GETCLASS(child))) return true;
+    }
+
+    return false;
+}
+
+/** Checks whether klass is base or one of its subclasses */
+bool classhierarchy_isderivedfrom(classhierarchy *h, objectclass *klass, objectclass *base) {
+    int first, last;
+
+    if (klass==base) return true;
+    if (!classhierarchy_subtree(h, base, &first, &last)) return _classhierarchy_walkderivedfrom(klass, base);
+
+    int i = _classhierarchy_find(h, klass);
+    return (i>=first && i<=last);
+}
+
+static bool _classhierarchy_findinlinearization(objectclass *klass, objectclass *target, int *out) {
+    for (int i=0; i<klass->linearization.count; i++) {
+        if (MORPHO_ISCLASS(klass->linearization.data[i]) &&
+            MORPHO_GETCLASS(klass->linearization.data[i])==target) {
+            *out=i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/** Finds the ancestor shared by two classes that is nearest to both in their linearizations */
+static bool _classhierarchy_computecommonancestor(objectclass *aclass, objectclass *bclass, value *out) {
+    objectclass *best = NULL;
+    int bestscore = INT_MAX;
+    int bestdepth = INT_MAX;
+
+    for (int i=0; i<aclass->linearization.count; i++) {
+        value candidate = aclass->linearization.data[i];
+        int j;
+
+        if (!MORPHO_ISCLASS(candidate)) continue;
+        if (!_classhierarchy_findinlinearization(bclass, MORPHO_GETCLASS(candidate), &j)) continue;
+
+        int score = ((i>j) ? i : j);
+        int depth = i+j;
+        if (!best || score<bestscore || (score==bestscore && depth<bestdepth)) {
+            best = MORPHO_GETCLASS(candidate);
+            bestscore = score;
+            bestdepth = depth;
+        }
+    }
+
+    if (!best) return false;
+    *out = MORPHO_OBJECT(best);
+    return true;
+}
+
+/** Finds the common ancestor of two classes, computing it once per pair; h may be NULL */
+bool classhierarchy_commonancestor(classhierarchy *h, objectclass *a, objectclass *b, value *out) {
+    value result=MORPHO_NIL;
+
+    if (!h) return _classhierarchy_computecommonancestor(a, b, out);
+
+    dictionary *ancestors = &h->nodes.data[_classhierarchy_find(h, a)].ancestors;
+    if (!dictionary_get(ancestors, MORPHO_OBJECT(b), &result)) {
+        if (!_classhierarchy_computecommonancestor(a, b, &result)) result=MORPHO_NIL;
+        dictionary_insert(ancestors, MORPHO_OBJECT(b), result);
+    }
+
+    if (MORPHO_ISNIL(result)) return false;
+    *out = result;
+    return true;
+}
+
 /* **********************************************************************
  * Methods/functions
  * ********************************************************************** */
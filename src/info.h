@@ -74,6 +74,33 @@ void classinfolist_startpass(classinfolist *clist);
 bool classinfolist_incrementconstructed(classinfolist *clist, objectclass *klass);
 int classinfolist_countconstructed(classinfolist *clist, objectclass *klass);
 
+/* **********************************************************************
+ * Class hierarchy
+ * ********************************************************************** */
+
+typedef struct {
+    objectclass *klass;
+    int last; /** Preorder number of the last class in its subtree */
+    bool istree; /** Whether no class in the subtree is also reached through another parent */
+    dictionary ancestors; /** Memoized common ancestors with other classes */
+} classnode;
+
+DECLARE_VARRAY(classnode, classnode)
+
+/** Classes numbered in preorder, so that a subtree occupies a contiguous range */
+struct classhierarchy {
+    varray_classnode nodes;
+    dictionary indx; /** Map classes to their preorder number */
+};
+
+void classhierarchy_init(classhierarchy *h);
+void classhierarchy_clear(classhierarchy *h);
+
+bool classhierarchy_isderivedfrom(classhierarchy *h, objectclass *klass, objectclass *base);
+bool classhierarchy_commonancestor(classhierarchy *h, objectclass *a, objectclass *b, value *out);
+bool classhierarchy_subtree(classhierarchy *h, objectclass *klass, int *first, int *last);
+objectclass *classhierarchy_class(classhierarchy *h, int i);
+
 /* **********************************************************************
  * Information about methods/functions
  * ********************************************************************** */
@@ -74,6 +74,22 @@ void lct_trackingfn(optimizer *opt) {
     if (optimize_typefromvalue(konst, &type)) {
         optimize_setexacttype(opt, DECODE_A(instr), type);
     }
+    if (MORPHO_ISINTEGER(konst)) {
+        optimize_setrange(opt, DECODE_A(instr), MORPHO_GETINTEGERVALUE(konst), MORPHO_GETINTEGERVALUE(konst));
+    }
+}
+
+void typecheck_trackingfn(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    registerindx r = DECODE_A(instr);
+    value type = optimize_getconstant(opt, DECODE_Bx(instr));
+
+    // A check that passed establishes the type, unless a stronger fact is already known
+    regtypeinfo info = optimize_typeprecision(type);
+    if (info==REGTYPE_UNKNOWN ||
+        optimize_typeinfo(opt, r)==REGTYPE_EXACT ||
+        optimize_satisfiestype(opt, r, type)) return;
+    optimize_settype(opt, r, type, info);
 }
 
 void lgl_trackingfn(optimizer *opt) {
@@ -97,6 +113,7 @@ void sgl_trackingfn(optimizer *opt) {
     int gindx=DECODE_Bx(instr);
     
     reginfolist_invalidate(&opt->rlist, REG_GLOBAL, gindx); // Wipe registers that mirror the global
+    optimize_recordglobalwrite(opt, gindx);
     
     indx kindx;
     if (optimize_isconstant(opt, rindx, &kindx)) {
@@ -109,18 +126,36 @@ void sgl_trackingfn(optimizer *opt) {
     globalinfolist_settype(glist, gindx, type, typeinfo);
 }
 
+/** Computes the range of an Int sum or difference; any unbounded or overflowing bound leaves the result unbounded */
+static bool _arithrange(instruction op, int blo, int bhi, int clo, int chi, int *lo, int *hi) {
+    if (op!=OP_ADD && op!=OP_SUB) return false;
+    if (blo==REGRANGE_MIN || bhi==REGRANGE_MAX || clo==REGRANGE_MIN || chi==REGRANGE_MAX) return false;
+
+    long long l = (op==OP_ADD ? (long long) blo + clo : (long long) blo - chi);
+    long long h = (op==OP_ADD ? (long long) bhi + chi : (long long) bhi - clo);
+    if (l<=REGRANGE_MIN || h>=REGRANGE_MAX) return false;
+
+    *lo=(int) l; *hi=(int) h;
+    return true;
+}
+
 void arith_trackingfn(optimizer *opt) {
     instruction instr = optimize_getinstruction(opt);
     registerindx a=DECODE_A(instr);
     registerindx b=DECODE_B(instr);
     registerindx c=DECODE_C(instr);
     
-    optimize_writevalue(opt, a);
-    
     value ta = MORPHO_NIL,
           tb = optimize_type(opt, b),
           tc = optimize_type(opt, c);
     
+    int blo, bhi, clo, chi, lo, hi; // Read operand ranges before a overwrites either operand
+    bool isranged = (optimize_intrange(opt, b, &blo, &bhi) &&
+                     optimize_intrange(opt, c, &clo, &chi) &&
+                     _arithrange(DECODE_OP(instr), blo, bhi, clo, chi, &lo, &hi));
+    
+    optimize_writevalue(opt, a);
+    
     if (tb==typeint && tc==typeint) {
         ta = typeint;
     } else if ((tb==typefloat && tc==typefloat) ||
@@ -130,6 +165,7 @@ void arith_trackingfn(optimizer *opt) {
     }
     
     if (!MORPHO_ISNIL(ta)) optimize_setexacttype(opt, a, ta);
+    if (isranged) optimize_setrange(opt, a, lo, hi);
 }
 
 void cmp_trackingfn(optimizer *opt) {
@@ -176,6 +212,18 @@ static void _applyreturntypefact(optimizer *opt, registerindx r, value callable)
     optimize_settype(opt, r, type, info);
 }
 
+/** Lists and tuples built from a constructor call have one element per argument; a single argument
+    may instead be a collection to convert, so its length is left unknown */
+static void _applyconstructorlength(optimizer *opt, registerindx r, value callable, int nargs, int nopt) {
+    if (!MORPHO_ISBUILTINFUNCTION(callable) || nopt>0 || nargs==1) return;
+
+    objectbuiltinfunction *builtin = MORPHO_GETBUILTINFUNCTION(callable);
+    if (!(builtin->flags & MORPHO_FN_CONSTRUCTOR)) return;
+
+    value type = signature_getreturntype(&builtin->sig);
+    if (MORPHO_ISEQUAL(type, typelist) || MORPHO_ISEQUAL(type, typetuple)) optimize_setlength(opt, r, nargs);
+}
+
 static void _markinitializerconstructoruse(optimizer *opt, value callable) {
     value method;
 
@@ -247,17 +295,10 @@ void call_trackingfn(optimizer *opt) {
     objectfunction *current = optimize_currentblock(opt)->func;
     registerindx originalcallee;
 
-    /* Calls can mutate globals or captured state. Drop cached nonlocal load facts
-       so later LGL/LUP instructions are not rewritten to stale register copies. */
-    reginfolist_generalizecontent(&opt->rlist, REG_GLOBAL);
-    reginfolist_generalizecontent(&opt->rlist, REG_UPVALUE);
-    
     value content=MORPHO_NIL;
     indx cindx;
     if (optimize_isconstant(opt, a, &cindx)) {
         content = optimize_getconstant(opt, cindx);
-    } else if (optimize_isglobal(opt, a, &cindx)) {
-        content = globalinfolist_type(optimize_globalinfolist(opt), (int) cindx);
     }
 
     _trackescapedcallables(opt, current, a+1, nargs+2*nopt);
@@ -278,12 +319,25 @@ void call_trackingfn(optimizer *opt) {
         returncallable = _trackreducedmetafunctioncall(opt, current, content, a+1, nargs, &freecallable);
     }
 
+    /* Calls can mutate globals or captured state. Drop the cached nonlocal load facts that the
+       callee may write so later LGL/LUP instructions are not rewritten to stale register copies. */
+    optimize_invalidatenonlocals(opt, returncallable);
+    functioneffect effect = optimize_calleffect(opt, returncallable);
+    if (MORPHO_ISBUILTINFUNCTION(returncallable)) { // A builtin may raise on arguments it does not accept
+        bool valid = optimize_builtinargsarevalid(opt, returncallable, a+1, nargs, nopt);
+        optimize_markcall(opt, valid);
+        optimize_raiseeffect(opt, (valid ? effect : FUNCTIONEFFECT_EFFECTFUL));
+    } else optimize_raiseeffect(opt, effect);
+    if (effect==FUNCTIONEFFECT_EFFECTFUL) optimize_invalidatelengths(opt);
+
     for (registerindx i=1; i<=nargs+2*nopt; i++) {
         optimize_writevalue(opt, a+i);
     }
     
     optimize_writevalue(opt, a);
     _applyreturntypefact(opt, a, returncallable);
+    _applyconstructorlength(opt, a, returncallable, nargs, nopt);
+    if (MORPHO_ISFUNCTION(returncallable)) optimize_applyreturnsummary(opt, a, MORPHO_GETFUNCTION(returncallable));
     if (freecallable) morpho_freeobject(returncallable);
 }
 
@@ -306,9 +360,11 @@ void invoke_trackingfn(optimizer *opt) {
     }
 
     /* Method dispatch has the same nonlocal side-effect risk as a direct call. */
-    reginfolist_generalizecontent(&opt->rlist, REG_GLOBAL);
-    reginfolist_generalizecontent(&opt->rlist, REG_UPVALUE);
+    optimize_invalidatenonlocals(opt, method);
     _trackescapedcallables(opt, current, a+2, nargs+2*nopt);
+    functioneffect effect = optimize_calleffect(opt, method);
+    optimize_raiseeffect(opt, effect);
+    if (effect==FUNCTIONEFFECT_EFFECTFUL) optimize_invalidatelengths(opt); // e.g. append or pop
     
     for (registerindx i=2; i<=nargs+2*nopt+1; i++) {
         optimize_writevalue(opt, a+i);
@@ -316,6 +372,12 @@ void invoke_trackingfn(optimizer *opt) {
     
     optimize_writevalue(opt, a+1);
     _applyreturntypefact(opt, a+1, method);
+    if (MORPHO_ISFUNCTION(method)) optimize_applyreturnsummary(opt, a+1, MORPHO_GETFUNCTION(method));
+}
+
+void return_trackingfn(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    optimize_recordreturn(opt, (DECODE_A(instr)>0) ? DECODE_B(instr) : REGISTER_UNALLOCATED);
 }
 
 void lup_trackingfn(optimizer *opt) {
@@ -326,6 +388,7 @@ void lup_trackingfn(optimizer *opt) {
 void sup_trackingfn(optimizer *opt) {
     instruction instr = optimize_getinstruction(opt);
     reginfolist_invalidate(&opt->rlist, REG_UPVALUE, DECODE_A(instr));
+    optimize_recordupvaluewrite(opt);
 }
 
 void lpr_trackingfn(optimizer *opt) {
@@ -340,11 +403,14 @@ void lpr_trackingfn(optimizer *opt) {
 
 void lix_trackingfn(optimizer *opt) {
     instruction instr = optimize_getinstruction(opt);
+    optimize_markaccess(opt, DECODE_B(instr)==DECODE_C(instr) &&
+                             optimize_isinbounds(opt, DECODE_A(instr), DECODE_B(instr)));
     optimize_writevalue(opt, DECODE_B(instr));
 }
 
 void lixl_trackingfn(optimizer *opt) {
     instruction instr = optimize_getinstruction(opt);
+    optimize_markaccess(opt, optimize_isinbounds(opt, DECODE_B(instr), DECODE_C(instr)));
     optimize_writevalue(opt, DECODE_A(instr));
 }
 
@@ -371,53 +437,53 @@ opcodeinfo opcodetable[] = {
     
     { OP_MOV, "mov", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_PROPAGATE, mov_trackingfn, NULL, NULL },
     
-    { OP_ADD, "add", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE, arith_trackingfn, NULL, NULL },
-    { OP_SUB, "sub", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE, arith_trackingfn, NULL, NULL },
-    { OP_MUL, "mul", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE, arith_trackingfn, NULL, NULL },
-    { OP_DIV, "div", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE, arith_trackingfn, NULL, NULL },
-    { OP_POW, "pow", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE, arith_trackingfn, NULL, NULL },
+    { OP_ADD, "add", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE | OPCODE_MAYRAISE, arith_trackingfn, NULL, NULL },
+    { OP_SUB, "sub", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE | OPCODE_MAYRAISE, arith_trackingfn, NULL, NULL },
+    { OP_MUL, "mul", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE | OPCODE_MAYRAISE, arith_trackingfn, NULL, NULL },
+    { OP_DIV, "div", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE | OPCODE_MAYRAISE, arith_trackingfn, NULL, NULL },
+    { OP_POW, "pow", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE | OPCODE_MAYRAISE, arith_trackingfn, NULL, NULL },
     
     { OP_NOT, "not", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_PROPAGATE, cmp_trackingfn, NULL, NULL },
     
     { OP_EQ, "eq",   OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE, cmp_trackingfn, NULL, NULL },
     { OP_NEQ, "neq", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE, cmp_trackingfn, NULL, NULL },
-    { OP_LT, "lt",   OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE, cmp_trackingfn, NULL, NULL },
-    { OP_LE, "le",   OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE, cmp_trackingfn, NULL, NULL },
+    { OP_LT, "lt",   OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE | OPCODE_MAYRAISE, cmp_trackingfn, NULL, NULL },
+    { OP_LE, "le",   OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_PROPAGATE | OPCODE_MAYRAISE, cmp_trackingfn, NULL, NULL },
     
-    { OP_PUSHERR, "pusherr",  OPCODE_ENDSBLOCK | OPCODE_NEWBLOCKAFTER | OPCODE_BRANCH_TABLE, NULL, NULL, NULL },
-    { OP_POPERR,  "poperr",   OPCODE_ENDSBLOCK | OPCODE_BRANCH, NULL, NULL, NULL },
+    { OP_PUSHERR, "pusherr",  OPCODE_ENDSBLOCK | OPCODE_NEWBLOCKAFTER | OPCODE_BRANCH_TABLE | OPCODE_IMPURE, NULL, NULL, NULL },
+    { OP_POPERR,  "poperr",   OPCODE_ENDSBLOCK | OPCODE_BRANCH | OPCODE_IMPURE, NULL, NULL, NULL },
     
     { OP_B,    "b",    OPCODE_ENDSBLOCK | OPCODE_BRANCH, NULL, NULL, NULL },
     { OP_BIF,  "bif",  OPCODE_ENDSBLOCK | OPCODE_BRANCH | OPCODE_NEWBLOCKAFTER | OPCODE_USES_A, NULL, NULL, NULL },
     { OP_BIFF, "biff", OPCODE_ENDSBLOCK | OPCODE_BRANCH | OPCODE_NEWBLOCKAFTER | OPCODE_USES_A, NULL, NULL, NULL },
     
-    { OP_CALL,    "call",    OPCODE_USES_A | OPCODE_OVERWRITES_A | OPCODE_NODELETE, call_trackingfn, call_usagefn, NULL },
-    { OP_INVOKE,  "invoke",  OPCODE_USES_A | OPCODE_OVERWRITES_AP1 | OPCODE_NODELETE, invoke_trackingfn, invoke_usagefn, NULL },
-    { OP_METHOD,  "method",  OPCODE_USES_A | OPCODE_OVERWRITES_AP1 | OPCODE_NODELETE, invoke_trackingfn, invoke_usagefn, NULL },
-    { OP_RETURN,  "return",  OPCODE_ENDSBLOCK | OPCODE_TERMINATING | OPCODE_PROPAGATE, NULL, return_usagefn, NULL },
+    { OP_CALL,    "call",    OPCODE_USES_A | OPCODE_OVERWRITES_A | OPCODE_NODELETE | OPCODE_MAYRAISE, call_trackingfn, call_usagefn, NULL },
+    { OP_INVOKE,  "invoke",  OPCODE_USES_A | OPCODE_OVERWRITES_AP1 | OPCODE_NODELETE | OPCODE_MAYRAISE, invoke_trackingfn, invoke_usagefn, NULL },
+    { OP_METHOD,  "method",  OPCODE_USES_A | OPCODE_OVERWRITES_AP1 | OPCODE_NODELETE | OPCODE_MAYRAISE, invoke_trackingfn, invoke_usagefn, NULL },
+    { OP_RETURN,  "return",  OPCODE_ENDSBLOCK | OPCODE_TERMINATING | OPCODE_PROPAGATE, return_trackingfn, return_usagefn, NULL },
     
     { OP_CLOSEUP, "closeup", OPCODE_NODELETE, NULL, NULL, NULL },
     
     { OP_LCT, "lct", OPCODE_OVERWRITES_A, lct_trackingfn, NULL, NULL },
-    { OP_LGL, "lgl", OPCODE_OVERWRITES_A, lgl_trackingfn, NULL, NULL },
-    { OP_SGL, "sgl", OPCODE_USES_A | OPCODE_NODELETE, sgl_trackingfn, NULL, NULL },
-    { OP_LPR, "lpr", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_NODELETE | OPCODE_PROPAGATE, lpr_trackingfn, NULL, NULL },
-    { OP_SPR, "spr", OPCODE_USES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_NODELETE | OPCODE_PROPAGATE, NULL, NULL, NULL },
-    { OP_LUP, "lup", OPCODE_OVERWRITES_A, lup_trackingfn, NULL, NULL },
-    { OP_SUP, "sup", OPCODE_USES_B | OPCODE_NODELETE | OPCODE_PROPAGATE, sup_trackingfn, NULL, NULL },
-    { OP_LIX, "lix", OPCODE_OVERWRITES_B | OPCODE_USES_A | OPCODE_USES_RANGEBC | OPCODE_NODELETE | OPCODE_PROPAGATE, lix_trackingfn, NULL, NULL },
-    { OP_LIXL, "lixl", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_NODELETE | OPCODE_PROPAGATE, lixl_trackingfn, NULL, NULL },
-    { OP_SIX, "six", OPCODE_USES_A | OPCODE_USES_RANGEBC | OPCODE_NODELETE | OPCODE_PROPAGATE, NULL, NULL, NULL },
+    { OP_LGL, "lgl", OPCODE_OVERWRITES_A | OPCODE_READSSTATE, lgl_trackingfn, NULL, NULL },
+    { OP_SGL, "sgl", OPCODE_USES_A | OPCODE_NODELETE | OPCODE_IMPURE, sgl_trackingfn, NULL, NULL },
+    { OP_LPR, "lpr", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_NODELETE | OPCODE_PROPAGATE | OPCODE_IMPURE | OPCODE_MAYRAISE, lpr_trackingfn, NULL, NULL },
+    { OP_SPR, "spr", OPCODE_USES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_NODELETE | OPCODE_PROPAGATE | OPCODE_IMPURE | OPCODE_MAYRAISE, NULL, NULL, NULL },
+    { OP_LUP, "lup", OPCODE_OVERWRITES_A | OPCODE_READSSTATE, lup_trackingfn, NULL, NULL },
+    { OP_SUP, "sup", OPCODE_USES_B | OPCODE_NODELETE | OPCODE_PROPAGATE | OPCODE_IMPURE, sup_trackingfn, NULL, NULL },
+    { OP_LIX, "lix", OPCODE_OVERWRITES_B | OPCODE_USES_A | OPCODE_USES_RANGEBC | OPCODE_NODELETE | OPCODE_PROPAGATE | OPCODE_IMPURE | OPCODE_MAYRAISE, lix_trackingfn, NULL, NULL },
+    { OP_LIXL, "lixl", OPCODE_OVERWRITES_A | OPCODE_USES_B | OPCODE_USES_C | OPCODE_NODELETE | OPCODE_PROPAGATE | OPCODE_IMPURE | OPCODE_MAYRAISE, lixl_trackingfn, NULL, NULL },
+    { OP_SIX, "six", OPCODE_USES_A | OPCODE_USES_RANGEBC | OPCODE_NODELETE | OPCODE_PROPAGATE | OPCODE_IMPURE | OPCODE_MAYRAISE, NULL, NULL, NULL },
     
     { OP_CLOSURE, "closure", OPCODE_OVERWRITES_A | OPCODE_USES_A | OPCODE_NODELETE, closure_trackingfn, closure_usagefn, NULL },
     
-    { OP_PRINT, "print", OPCODE_USES_A | OPCODE_NODELETE | OPCODE_PROPAGATE, NULL, NULL, NULL },
+    { OP_PRINT, "print", OPCODE_USES_A | OPCODE_NODELETE | OPCODE_PROPAGATE | OPCODE_IMPURE | OPCODE_MAYRAISE, NULL, NULL, NULL },
     
-    { OP_TYPECHECK, "typecheck", OPCODE_USES_A | OPCODE_NODELETE | OPCODE_PROPAGATE, NULL, NULL, NULL },
+    { OP_TYPECHECK, "typecheck", OPCODE_USES_A | OPCODE_NODELETE | OPCODE_PROPAGATE | OPCODE_IMPURE | OPCODE_MAYRAISE, typecheck_trackingfn, NULL, NULL },
     
-    { OP_BREAK, "break", OPCODE_BLANK, NULL, NULL, NULL },
+    { OP_BREAK, "break", OPCODE_IMPURE, NULL, NULL, NULL },
     
-    { OP_CAT, "cat", OPCODE_OVERWRITES_A | OPCODE_USES_RANGEBC, cat_trackingfn, NULL, NULL },
+    { OP_CAT, "cat", OPCODE_OVERWRITES_A | OPCODE_USES_RANGEBC | OPCODE_IMPURE | OPCODE_MAYRAISE, cat_trackingfn, NULL, NULL },
     
     { OP_END, "end", OPCODE_ENDSBLOCK | OPCODE_TERMINATING, NULL, NULL, NULL }
 };
@@ -28,6 +28,9 @@ typedef unsigned int opcodeflags;
 #define OPCODE_NODELETE         (1<<12) /* Generic dead-code elimination must not erase this opcode. */
 #define OPCODE_UNSUPPORTED      (1<<13)
 #define OPCODE_PROPAGATE        (1<<14)
+#define OPCODE_IMPURE           (1<<15) /* Writes nonlocal state, produces output or may raise */
+#define OPCODE_READSSTATE       (1<<16) /* Reads globals or upvalues */
+#define OPCODE_MAYRAISE         (1<<17) /* May raise an error */
 
 #define OP_INSERT           (OP_END+1)
 #define OP_INSERT_RESTART   (OP_END+2)
@@ -16,6 +16,10 @@
 #include "layout.h"
 
 DEFINE_VARRAY(functioninputinfo, functioninputinfo)
+DEFINE_VARRAY(functionsummary, functionsummary)
+DEFINE_VARRAY(availableload, availableload)
+DEFINE_VARRAY(reductionquery, reductionquery)
+DEFINE_VARRAY(methodquery, methodquery)
 
 /* **********************************************************************
  * Optimizer data structure
@@ -33,12 +37,29 @@ void optimizer_init(optimizer *opt, program *prog) {
     reginfolist_init(&opt->rlist, MORPHO_MAXREGISTERS);
     globalinfolist_init(&opt->glist, prog->globals.count);
     classinfolist_init(&opt->classinfo);
+    classhierarchy_init(&opt->classes);
+    reginfo_setclasshierarchy(&opt->classes);
     functioninfolist_init(&opt->functioninfo);
     varray_functioninputinfoinit(&opt->functioninputs);
     dictionary_init(&opt->functioninputindx);
+    varray_functionsummaryinit(&opt->summaries);
+    dictionary_init(&opt->summaryindx);
+    varray_instructionindxinit(&opt->summaryqueue);
     dictionary_init(&opt->requirednregs);
     dictionary_init(&opt->processedlabels);
+    dictionary_init(&opt->inboundsaccesses);
+    dictionary_init(&opt->validcalls);
+    varray_availableloadinit(&opt->availableloads);
+    varray_valueinit(&opt->boundconstants);
+    dictionary_init(&opt->internedconstants);
+    varray_reductionqueryinit(&opt->reductions);
+    varray_valueinit(&opt->reductiontypes);
+    dictionary_init(&opt->reductionindx);
+    varray_methodqueryinit(&opt->methodqueries);
+    dictionary_init(&opt->methodqueryindx);
     varray_instructioninit(&opt->insertions);
+    dictionary_init(&opt->clonedfunctions);
+    opt->nclonedinstructions=0;
     
     opt->v=morpho_newvm();
     opt->temp=morpho_newprogram();
@@ -59,6 +80,17 @@ static void optimize_clearfunctioninputs(optimizer *opt) {
     opt->ipachanged=false;
 }
 
+static void optimize_clearsummaries(optimizer *opt) {
+    for (int i=0; i<opt->summaries.count; i++) {
+        dictionary_clear(&opt->summaries.data[i].dependents);
+        dictionary_clear(&opt->summaries.data[i].modglobals);
+    }
+    opt->summaries.count=0;
+    dictionary_clear(&opt->summaryindx);
+    dictionary_init(&opt->summaryindx);
+    opt->summaryqueue.count=0;
+}
+
 /** Clears an optimizer data structure */
 void optimize_clear(optimizer *opt) {
     error_clear(&opt->err);
@@ -67,13 +99,30 @@ void optimize_clear(optimizer *opt) {
     reginfolist_clear(&opt->rlist);
     globalinfolist_clear(&opt->glist);
     classinfolist_clear(&opt->classinfo);
+    reginfo_setclasshierarchy(NULL);
+    classhierarchy_clear(&opt->classes);
     functioninfolist_clear(&opt->functioninfo);
     optimize_clearfunctioninputs(opt);
     varray_functioninputinfoclear(&opt->functioninputs);
     dictionary_clear(&opt->functioninputindx);
+    optimize_clearsummaries(opt);
+    varray_functionsummaryclear(&opt->summaries);
+    dictionary_clear(&opt->summaryindx);
+    varray_instructionindxclear(&opt->summaryqueue);
     dictionary_clear(&opt->requirednregs);
     dictionary_clear(&opt->processedlabels);
+    dictionary_clear(&opt->inboundsaccesses);
+    dictionary_clear(&opt->validcalls);
+    varray_availableloadclear(&opt->availableloads);
+    varray_valueclear(&opt->boundconstants);
+    dictionary_clear(&opt->internedconstants);
+    varray_reductionqueryclear(&opt->reductions);
+    varray_valueclear(&opt->reductiontypes);
+    dictionary_clear(&opt->reductionindx);
+    varray_methodqueryclear(&opt->methodqueries);
+    dictionary_clear(&opt->methodqueryindx);
     varray_instructionclear(&opt->insertions);
+    dictionary_clear(&opt->clonedfunctions);
     
     if (opt->v) morpho_freevm(opt->v);
     if (opt->temp) morpho_freeprogram(opt->temp);
@@ -204,12 +253,52 @@ static void _optimize_initregfact(reginfo *info) {
     info->iindx=INSTRUCTIONINDX_EMPTY;
     info->type=MORPHO_NIL;
     info->typeinfo=REGTYPE_UNKNOWN;
+    info->length=REGLENGTH_UNKNOWN;
+    info->lo=REGRANGE_MIN;
+    info->hi=REGRANGE_MAX;
     info->hasalias=false;
     info->alias=0;
 }
 
+/** Checks whether a constant is an immutable object that functions can share */
+static bool _optimize_isinternable(value val) {
+    if (MORPHO_ISSTRING(val) || MORPHO_ISRANGE(val) || MORPHO_ISCOMPLEX(val)) return true;
+    if (!MORPHO_ISTUPLE(val)) return false;
+
+    objecttuple *tuple = MORPHO_GETTUPLE(val);
+    for (unsigned int i=0; i<tuple->length; i++) {
+        if (MORPHO_ISOBJECT(tuple->tuple[i]) && !_optimize_isinternable(tuple->tuple[i])) return false;
+    }
+    return true;
+}
+
+/** Returns the program-wide instance of an immutable constant, making val the instance if there is none yet */
+static value _optimize_internconstant(optimizer *opt, value val) {
+    value instance;
+
+    if (!MORPHO_ISOBJECT(val) || !_optimize_isinternable(val)) return val;
+    if (dictionary_get(&opt->internedconstants, val, &instance)) return instance;
+
+    dictionary_insert(&opt->internedconstants, val, val);
+    return val;
+}
+
+/** Binds an object constant to the program, recording objects that the optimizer created */
+static void _optimize_bindconstant(optimizer *opt, value val) {
+    object *obj = MORPHO_GETOBJECT(val);
+    if (obj->status==OBJECT_ISUNMANAGED) varray_valuewrite(&opt->boundconstants, val);
+    program_bindobject(opt->prog, obj);
+}
+
 static bool _optimize_addconstanttofunction(optimizer *opt, objectfunction *func, value val, indx *out) {
     unsigned int k;
+    value instance = _optimize_internconstant(opt, val);
+
+    // A duplicate stays alive for the caller and is freed with the other unreferenced constants
+    if (MORPHO_ISOBJECT(val) && MORPHO_GETOBJECT(instance)!=MORPHO_GETOBJECT(val)) {
+        _optimize_bindconstant(opt, val);
+        val=instance;
+    }
 
     if (varray_valuefindsame(&func->konst, val, &k)) {
         *out = (indx) k;
@@ -219,7 +308,7 @@ static bool _optimize_addconstanttofunction(optimizer *opt, objectfunction *func
     if (!varray_valueadd(&func->konst, &val, 1)) return false;
     *out=func->konst.count-1;
 
-    if (MORPHO_ISOBJECT(val)) program_bindobject(opt->prog, MORPHO_GETOBJECT(val));
+    if (MORPHO_ISOBJECT(val)) _optimize_bindconstant(opt, val);
     return true;
 }
 
@@ -387,17 +476,9 @@ bool optimize_classisleaf(objectclass *klass) {
     return (klass && klass->children.count==0);
 }
 
-bool optimize_classisderivedfrom(objectclass *klass, objectclass *base) {
+bool optimize_classisderivedfrom(optimizer *opt, objectclass *klass, objectclass *base) {
     if (!klass || !base) return false;
-    if (klass==base) return true;
-
-    for (unsigned int i=0; i<base->children.count; i++) {
-        value child = base->children.data[i];
-        if (MORPHO_ISCLASS(child) &&
-            optimize_classisderivedfrom(klass, MORPHO_GETCLASS(child))) return true;
-    }
-
-    return false;
+    return classhierarchy_isderivedfrom(&opt->classes, klass, base);
 }
 
 static bool _optimize_canspecializeself(optimizer *opt, objectfunction *func, registerindx selfreg) {
@@ -407,7 +488,7 @@ static bool _optimize_canspecializeself(optimizer *opt, objectfunction *func, re
     value selftype = optimize_type(opt, selfreg);
     if (!MORPHO_ISCLASS(selftype)) return false;
 
-    return optimize_classisderivedfrom(MORPHO_GETCLASS(selftype), func->klass);
+    return optimize_classisderivedfrom(opt, MORPHO_GETCLASS(selftype), func->klass);
 }
 
 bool optimize_recordcallsite(optimizer *opt, objectfunction *func, registerindx argstart, int nargs, registerindx selfreg) {
@@ -424,6 +505,574 @@ bool optimize_recordcallsite(optimizer *opt, objectfunction *func, registerindx
     return changed;
 }
 
+/* -------------------------------------
+ * Return summaries
+ * ------------------------------------- */
+
+static functionsummary *_optimize_functionsummary(optimizer *opt, objectfunction *func) {
+    value ix;
+    if (dictionary_get(&opt->summaryindx, MORPHO_OBJECT(func), &ix) && MORPHO_ISINTEGER(ix)) {
+        return &opt->summaries.data[MORPHO_GETINTEGERVALUE(ix)];
+    }
+
+    functionsummary summary;
+    summary.func=func;
+    _optimize_initregfact(&summary.ret);
+    summary.effect=FUNCTIONEFFECT_PURE;
+    dictionary_init(&summary.dependents);
+    dictionary_init(&summary.modglobals);
+    summary.modallglobals=false;
+    summary.modupvalues=false;
+    if (!varray_functionsummaryadd(&opt->summaries, &summary, 1)) {
+        dictionary_clear(&summary.dependents);
+        dictionary_clear(&summary.modglobals);
+        return NULL;
+    }
+
+    dictionary_insert(&opt->summaryindx, MORPHO_OBJECT(func), MORPHO_INTEGER(opt->summaries.count-1));
+    return &opt->summaries.data[opt->summaries.count-1];
+}
+
+/** Revisits every call site that already consumed a summary that has since changed */
+static void _optimize_queuedependents(optimizer *opt, functionsummary *summary) {
+    for (int i=0; i<summary->dependents.capacity; i++) {
+        value key = summary->dependents.contents[i].key;
+        if (MORPHO_ISINTEGER(key)) varray_instructionindxwrite(&opt->summaryqueue, MORPHO_GETINTEGERVALUE(key));
+    }
+}
+
+/** Joins the operand of a return instruction into the summary of the current function;
+    r is REGISTER_UNALLOCATED for a bare return, which yields nil */
+void optimize_recordreturn(optimizer *opt, registerindx r) {
+    objectfunction *func = optimize_currentblock(opt)->func;
+    functionsummary *summary;
+    reginfo incoming;
+    value type;
+    indx kindx;
+
+    if (func==opt->prog->global || !(summary=_optimize_functionsummary(opt, func))) return;
+
+    _optimize_initregfact(&incoming);
+    incoming.contents=REG_VALUE;
+    incoming.usage=REGUSE_WRITTEN;
+
+    if (r==REGISTER_UNALLOCATED) {
+        if (_optimize_addconstanttofunction(opt, func, MORPHO_NIL, &kindx)) {
+            incoming.contents=REG_CONSTANT;
+            incoming.indx=kindx;
+        }
+    } else if (optimize_isconstant(opt, r, &kindx)) {
+        incoming.contents=REG_CONSTANT;
+        incoming.indx=kindx;
+        if (optimize_typefromvalue(optimize_getconstant(opt, kindx), &type)) {
+            incoming.type=type;
+            incoming.typeinfo=REGTYPE_EXACT;
+        }
+    } else {
+        type=optimize_type(opt, r);
+        if (!MORPHO_ISNIL(type)) {
+            incoming.contents=REG_TYPEDVALUE;
+            incoming.type=type;
+            incoming.typeinfo=optimize_typeinfo(opt, r);
+        }
+    }
+
+    reginfo old = summary->ret;
+    if (old.contents==REG_NOFACT) summary->ret=incoming;
+    else reginfo_join(&summary->ret, &incoming);
+
+    if (!reginfo_equal(&old, &summary->ret)) _optimize_queuedependents(opt, summary);
+}
+
+/** Registers the current block as a call site that depends on a summary */
+static void _optimize_adddependent(optimizer *opt, functionsummary *summary) {
+    blockindx bindx;
+    if (cfgraph_findindx(&opt->graph, optimize_currentblock(opt), &bindx)) {
+        dictionary_insert(&summary->dependents, MORPHO_INTEGER((int) bindx), MORPHO_NIL);
+    }
+}
+
+/** Applies the return summary of a known callee to the register receiving its result */
+void optimize_applyreturnsummary(optimizer *opt, registerindx r, objectfunction *func) {
+    functionsummary *summary = _optimize_functionsummary(opt, func);
+    indx kindx;
+
+    if (!summary) return;
+    _optimize_adddependent(opt, summary);
+
+    reginfo *ret = &summary->ret;
+    if (ret->contents==REG_CONSTANT && ret->indx<func->konst.count &&
+        optimize_addconstant(opt, func->konst.data[ret->indx], &kindx)) {
+        optimize_write(opt, r, REG_CONSTANT, kindx);
+        if (ret->typeinfo==REGTYPE_EXACT) optimize_setexacttype(opt, r, ret->type);
+    } else if ((ret->contents==REG_CONSTANT || ret->contents==REG_TYPEDVALUE) &&
+               !MORPHO_ISNIL(ret->type)) {
+        optimize_settype(opt, r, ret->type, ret->typeinfo);
+    }
+}
+
+/* -------------------------------------
+ * Effect summaries
+ * ------------------------------------- */
+
+/** Raises the effect class of the current function; call sites that relied on a weaker class are revisited */
+void optimize_raiseeffect(optimizer *opt, functioneffect effect) {
+    objectfunction *func = optimize_currentblock(opt)->func;
+    functionsummary *summary;
+
+    if (effect==FUNCTIONEFFECT_PURE ||
+        func==opt->prog->global || !(summary=_optimize_functionsummary(opt, func))) return;
+
+    if (effect<=summary->effect) return;
+    summary->effect=effect;
+    _optimize_queuedependents(opt, summary);
+}
+
+/** Returns the effect class of calling a callable; functions whose code is not in the graph and
+    anything that cannot be resolved are treated as effectful */
+functioneffect optimize_calleffect(optimizer *opt, value callable) {
+    if (MORPHO_ISBUILTINFUNCTION(callable)) {
+        objectbuiltinfunction *builtin = MORPHO_GETBUILTINFUNCTION(callable);
+        return ((builtin->flags & MORPHO_FN_PUREFN) ? FUNCTIONEFFECT_PURE : FUNCTIONEFFECT_EFFECTFUL);
+    }
+
+    if (MORPHO_ISFUNCTION(callable)) {
+        objectfunction *func = MORPHO_GETFUNCTION(callable);
+        functionsummary *summary;
+        if (functioninfolist_countblocks(&opt->functioninfo, func)>0 &&
+            (summary=_optimize_functionsummary(opt, func))) return summary->effect;
+    }
+
+    return FUNCTIONEFFECT_EFFECTFUL;
+}
+
+/* -------------------------------------
+ * Mod/ref summaries
+ * ------------------------------------- */
+
+/** Returns the summary of the function being analyzed, or NULL for the global function */
+static functionsummary *_optimize_currentsummary(optimizer *opt) {
+    objectfunction *func = optimize_currentblock(opt)->func;
+    if (func==opt->prog->global) return NULL;
+    return _optimize_functionsummary(opt, func);
+}
+
+/** Records that the current function writes a global */
+void optimize_recordglobalwrite(optimizer *opt, indx gindx) {
+    functionsummary *summary = _optimize_currentsummary(opt);
+    if (!summary || summary->modallglobals ||
+        dictionary_get(&summary->modglobals, MORPHO_INTEGER((int) gindx), NULL)) return;
+
+    dictionary_insert(&summary->modglobals, MORPHO_INTEGER((int) gindx), MORPHO_NIL);
+    _optimize_queuedependents(opt, summary);
+}
+
+/** Records that the current function writes an upvalue */
+void optimize_recordupvaluewrite(optimizer *opt) {
+    functionsummary *summary = _optimize_currentsummary(opt);
+    if (!summary || summary->modupvalues) return;
+
+    summary->modupvalues=true;
+    _optimize_queuedependents(opt, summary);
+}
+
+/** Records that the current function may write any global */
+static void _optimize_recordallglobalwrites(optimizer *opt) {
+    functionsummary *summary = _optimize_currentsummary(opt);
+    if (!summary || summary->modallglobals) return;
+
+    summary->modallglobals=true;
+    _optimize_queuedependents(opt, summary);
+}
+
+/** Invalidates the register facts for globals and upvalues that a call may write, and joins the
+    callee's mod set into that of the current function; unknown callees invalidate everything */
+void optimize_invalidatenonlocals(optimizer *opt, value callable) {
+    functionsummary *callee = NULL;
+
+    if (MORPHO_ISBUILTINFUNCTION(callable) &&
+        (MORPHO_GETBUILTINFUNCTION(callable)->flags & MORPHO_FN_PUREFN)) return;
+
+    _optimize_currentsummary(opt); // Create the caller's summary first so the callee's pointer stays valid
+    if (MORPHO_ISFUNCTION(callable) &&
+        functioninfolist_countblocks(&opt->functioninfo, MORPHO_GETFUNCTION(callable))>0) {
+        callee=_optimize_functionsummary(opt, MORPHO_GETFUNCTION(callable));
+    }
+
+    if (!callee) {
+        reginfolist_generalizecontent(&opt->rlist, REG_GLOBAL);
+        reginfolist_generalizecontent(&opt->rlist, REG_UPVALUE);
+        _optimize_recordallglobalwrites(opt);
+        optimize_recordupvaluewrite(opt);
+        return;
+    }
+
+    _optimize_adddependent(opt, callee);
+
+    if (callee->modallglobals) {
+        reginfolist_generalizecontent(&opt->rlist, REG_GLOBAL);
+        _optimize_recordallglobalwrites(opt);
+    } else {
+        for (int i=0; i<callee->modglobals.capacity; i++) {
+            value key = callee->modglobals.contents[i].key;
+            if (!MORPHO_ISINTEGER(key)) continue;
+            reginfolist_invalidate(&opt->rlist, REG_GLOBAL, MORPHO_GETINTEGERVALUE(key));
+            optimize_recordglobalwrite(opt, MORPHO_GETINTEGERVALUE(key));
+        }
+    }
+
+    if (callee->modupvalues) {
+        reginfolist_generalizecontent(&opt->rlist, REG_UPVALUE);
+        optimize_recordupvaluewrite(opt);
+    }
+}
+
+static bool _isnumerictype(value type) {
+    return (MORPHO_ISEQUAL(type, typeint) ||
+            MORPHO_ISEQUAL(type, typefloat));
+}
+
+/** Determines the effect of the current instruction before it is tracked; calls are classified by their tracking functions */
+static functioneffect _optimize_instructioneffect(optimizer *opt, instruction instr) {
+    instruction op = DECODE_OP(instr);
+    opcodeflags flags = opcode_getflags(op);
+
+    if (flags & OPCODE_IMPURE) return FUNCTIONEFFECT_EFFECTFUL;
+    if (flags & OPCODE_READSSTATE) return FUNCTIONEFFECT_READONLY;
+
+    switch (op) {
+        case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV: case OP_POW:
+        case OP_LT: case OP_LE: // Non-numeric operands may dispatch to user methods or raise
+            if (!_isnumerictype(optimize_type(opt, DECODE_B(instr))) ||
+                !_isnumerictype(optimize_type(opt, DECODE_C(instr)))) return FUNCTIONEFFECT_EFFECTFUL;
+            break;
+        default:
+            break;
+    }
+
+    return FUNCTIONEFFECT_PURE;
+}
+
+/** Finds the last instruction in blk before a given index that writes register r; fails if a call clobbers it first */
+bool optimize_findwriter(optimizer *opt, block *blk, registerindx r, instructionindx before, instructionindx *out) {
+    for (instructionindx i=before-1; i>=blk->start; i--) {
+        instruction instr = optimize_getinstructionat(opt, i);
+        instruction op = DECODE_OP(instr);
+        registerindx overwrites;
+
+        if (op==OP_INSERT || op==OP_INSERT_RESTART) return false;
+        if (op==OP_CALL || op==OP_INVOKE || op==OP_METHOD) {
+            registerindx a = DECODE_A(instr);
+            if (r>=a && r<=a+DECODE_B(instr)+2*DECODE_C(instr)+1) {
+                if (op==OP_CALL && r==a) { *out=i; return true; }
+                return false;
+            }
+            continue;
+        }
+
+        if (opcode_overwritesforinstruction(instr, &overwrites) && overwrites==r) {
+            *out=i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Identifies the constant callee of the call instruction at iindx from the lct that loaded it */
+bool optimize_calltarget(optimizer *opt, block *blk, instructionindx iindx, value *out) {
+    instruction instr = optimize_getinstructionat(opt, iindx);
+    instructionindx src;
+
+    if (DECODE_OP(instr)!=OP_CALL ||
+        !optimize_findwriter(opt, blk, DECODE_A(instr), iindx, &src)) return false;
+
+    instruction load = optimize_getinstructionat(opt, src);
+    if (DECODE_OP(load)!=OP_LCT) return false;
+
+    *out = optimize_getconstant(opt, DECODE_Bx(load));
+    return true;
+}
+
+/* -------------------------------------
+ * Query caches
+ * ------------------------------------- */
+
+/** Finds the first memoized query for a key in an index, or -1 */
+static int _optimize_firstquery(dictionary *index, value key) {
+    value first;
+    if (dictionary_get(index, key, &first) && MORPHO_ISINTEGER(first)) return MORPHO_GETINTEGERVALUE(first);
+    return -1;
+}
+
+static bool _optimize_sametypes(optimizer *opt, reductionquery *q, int nargs, value *types) {
+    if (q->nargs!=nargs) return false;
+    for (int i=0; i<nargs; i++) {
+        if (!MORPHO_ISEQUAL(opt->reductiontypes.data[q->types+i], types[i])) return false;
+    }
+    return true;
+}
+
+/** Reduces a metafunction for the types of its arguments, nil where unknown; results, including failures, are
+    memoized for the lifetime of the optimizer since metafunctions are not modified while optimizing */
+bool optimize_reducemetafunction(optimizer *opt, value fn, int nargs, value *types, value *out) {
+    int first = _optimize_firstquery(&opt->reductionindx, fn);
+
+    for (int i=first; i>=0; i=opt->reductions.data[i].next) {
+        reductionquery *q = &opt->reductions.data[i];
+        if (!_optimize_sametypes(opt, q, nargs, types)) continue;
+        if (q->success) *out = q->result;
+        return q->success;
+    }
+
+    error err;
+    error_init(&err);
+    value result=MORPHO_NIL;
+    bool success=metafunction_reduce(MORPHO_GETMETAFUNCTION(fn), nargs, types, &err, &result);
+    error_clear(&err);
+
+    reductionquery q = { .fn = fn, .nargs = nargs, .types = opt->reductiontypes.count,
+                         .success = success, .result = result, .next = first };
+    varray_valueadd(&opt->reductiontypes, types, nargs);
+    dictionary_insert(&opt->reductionindx, fn, MORPHO_INTEGER(varray_reductionquerywrite(&opt->reductions, q)));
+
+    if (success) *out = result;
+    return success;
+}
+
+static bool _optimize_classhasmethod(objectclass *klass, value label, value expected) {
+    value candidate;
+    return (morpho_lookupmethod(MORPHO_OBJECT(klass), label, &candidate) && MORPHO_ISEQUAL(candidate, expected));
+}
+
+static bool _optimize_walkuniquemethod(objectclass *klass, value label, value expected) {
+    if (!_optimize_classhasmethod(klass, label, expected)) return false;
+
+    for (unsigned int i=0; i<klass->children.count; i++) {
+        value child = klass->children.data[i];
+        if (MORPHO_ISCLASS(child) &&
+            !_optimize_walkuniquemethod(MORPHO_GETCLASS(child), label, expected)) return false;
+    }
+
+    return true;
+}
+
+/** Checks that every class in a subtree resolves a label to the same implementation */
+static bool _optimize_subtreehasuniquemethod(optimizer *opt, objectclass *klass, value label, value expected) {
+    int first, last;
+
+    if (!classhierarchy_subtree(&opt->classes, klass, &first, &last)) return _optimize_walkuniquemethod(klass, label, expected);
+
+    for (int i=first; i<=last; i++) {
+        if (!_optimize_classhasmethod(classhierarchy_class(&opt->classes, i), label, expected)) return false;
+    }
+    return true;
+}
+
+/** Looks up the method a class provides for a label, and whether its subclasses all inherit it; memoized,
+    including when the class doesn't provide the method */
+bool optimize_lookupmethod(optimizer *opt, value klass, value label, value *method, bool *unique) {
+    int first = _optimize_firstquery(&opt->methodqueryindx, klass), i;
+
+    for (i=first; i>=0; i=opt->methodqueries.data[i].next) {
+        if (MORPHO_ISEQUAL(opt->methodqueries.data[i].label, label)) break;
+    }
+
+    if (i<0) {
+        methodquery q = { .klass = klass, .label = label, .method = MORPHO_NIL, .next = first };
+        q.found = morpho_lookupmethod(klass, label, &q.method);
+        q.unique = (q.found && _optimize_subtreehasuniquemethod(opt, MORPHO_GETCLASS(klass), label, q.method));
+        i = varray_methodquerywrite(&opt->methodqueries, q);
+        dictionary_insert(&opt->methodqueryindx, klass, MORPHO_INTEGER(i));
+    }
+
+    methodquery *q = &opt->methodqueries.data[i];
+    if (q->found) *method = q->method;
+    if (unique) *unique = q->unique;
+    return q->found;
+}
+
+/* -------------------------------------
+ * Available loads
+ * ------------------------------------- */
+
+/** Checks whether an available load refers to register r, or to any register from r if above is set */
+static bool _optimize_availablerefers(availableload *load, registerindx r, bool above) {
+    bool isindex = MORPHO_ISNIL(load->label);
+    if (above) return (load->obj>=r || load->dest>=r || (isindex && load->index>=r));
+    return (load->obj==r || load->dest==r || (isindex && load->index==r));
+}
+
+/** Removes available loads that refer to register r or, if above is set, to any register from r */
+static void _optimize_killavailable(optimizer *opt, registerindx r, bool above) {
+    int k=0;
+
+    for (int i=0; i<opt->availableloads.count; i++) {
+        availableload *load = &opt->availableloads.data[i];
+        if (!_optimize_availablerefers(load, r, above)) opt->availableloads.data[k++]=*load;
+    }
+    opt->availableloads.count=k;
+}
+
+/** Removes available loads of a property label, or of every index access if label is nil */
+static void _optimize_killavailablelabel(optimizer *opt, value label) {
+    int k=0;
+
+    for (int i=0; i<opt->availableloads.count; i++) {
+        availableload *load = &opt->availableloads.data[i];
+        if (!MORPHO_ISEQUAL(load->label, label)) opt->availableloads.data[k++]=*load;
+    }
+    opt->availableloads.count=k;
+}
+
+/** Records that register dest holds a property or, if label is nil, an element of the object in obj */
+static void _optimize_addavailable(optimizer *opt, registerindx obj, value label, registerindx index, registerindx dest) {
+    availableload load = { .obj = obj, .label = label, .index = index, .dest = dest };
+    varray_availableloadwrite(&opt->availableloads, load);
+}
+
+/** Checks whether register r holds a List */
+static bool _optimize_islist(optimizer *opt, registerindx r) {
+    return MORPHO_ISEQUAL(optimize_type(opt, r), typelist);
+}
+
+/** Checks whether an instruction can neither modify an object nor run user code that might */
+static bool _optimize_preservesproperties(optimizer *opt, instruction instr) {
+    instruction op = DECODE_OP(instr);
+    value type;
+
+    switch (op) {
+        case OP_LPR: case OP_SGL: case OP_SUP: case OP_TYPECHECK:
+            return true;
+        case OP_LIX: case OP_LIXL: // Indexing an instance may call its index method
+            type = optimize_type(opt, (op==OP_LIX ? DECODE_A(instr) : DECODE_B(instr)));
+            return (MORPHO_ISEQUAL(type, typelist) || MORPHO_ISEQUAL(type, typetuple));
+        default:
+            return (_optimize_instructioneffect(opt, instr)!=FUNCTIONEFFECT_EFFECTFUL);
+    }
+}
+
+/** Updates the available loads for an instruction before its facts are tracked */
+static void _optimize_updateavailable(optimizer *opt, instruction instr) {
+    instruction op = DECODE_OP(instr);
+    registerindx w;
+    indx kindx;
+
+    if (op==OP_CALL || op==OP_INVOKE || op==OP_METHOD) {
+        // The call frame clobbers registers from A; only callees that write nothing keep the rest
+        if (op==OP_CALL && optimize_isconstant(opt, DECODE_A(instr), &kindx) &&
+            optimize_calleffect(opt, optimize_getconstant(opt, kindx))<=FUNCTIONEFFECT_READONLY) {
+            _optimize_killavailable(opt, DECODE_A(instr), true);
+        } else opt->availableloads.count=0;
+        return;
+    }
+
+    if (op==OP_SPR) { // Any object may alias the target, but other labels are untouched
+        if (optimize_isconstant(opt, DECODE_B(instr), &kindx)) {
+            value label = optimize_getconstant(opt, kindx);
+            _optimize_killavailablelabel(opt, label);
+            _optimize_addavailable(opt, DECODE_A(instr), label, 0, DECODE_C(instr));
+        } else opt->availableloads.count=0;
+        return;
+    }
+
+    if (op==OP_SIX) { // Storing to a List may change any element of any aliasing List
+        if (_optimize_islist(opt, DECODE_A(instr))) {
+            _optimize_killavailablelabel(opt, MORPHO_NIL);
+            if (DECODE_C(instr)==DECODE_B(instr)+1) _optimize_addavailable(opt, DECODE_A(instr), MORPHO_NIL, DECODE_B(instr), DECODE_C(instr));
+        } else opt->availableloads.count=0;
+        return;
+    }
+
+    if (!_optimize_preservesproperties(opt, instr)) {
+        opt->availableloads.count=0;
+        return;
+    }
+
+    if (opcode_overwritesforinstruction(instr, &w)) _optimize_killavailable(opt, w, false);
+
+    if (op==OP_LPR && DECODE_A(instr)!=DECODE_B(instr) &&
+        optimize_isconstant(opt, DECODE_C(instr), &kindx)) {
+        _optimize_addavailable(opt, DECODE_B(instr), optimize_getconstant(opt, kindx), 0, DECODE_A(instr));
+    }
+}
+
+/** Finds a register that still holds the property of the object in register obj with the label in register label */
+bool optimize_findavailableproperty(optimizer *opt, registerindx obj, registerindx label, registerindx *out) {
+    indx kindx;
+    if (!optimize_isconstant(opt, label, &kindx)) return false;
+    value lbl = optimize_getconstant(opt, kindx);
+
+    for (int i=0; i<opt->availableloads.count; i++) {
+        availableload *load = &opt->availableloads.data[i];
+        if (load->obj==obj && MORPHO_ISEQUAL(load->label, lbl)) {
+            *out = load->dest;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Finds a register that still holds the element of the List in register obj at the index in register index */
+bool optimize_findavailableindex(optimizer *opt, registerindx obj, registerindx index, registerindx *out) {
+    for (int i=0; i<opt->availableloads.count; i++) {
+        availableload *load = &opt->availableloads.data[i];
+        if (load->obj==obj && MORPHO_ISNIL(load->label) && load->index==index) {
+            *out = load->dest;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** Checks whether a call matches the arity of a user function, so that it cannot raise on its arguments */
+static bool _optimize_callmatchesarity(instruction instr, objectfunction *func) {
+    return (DECODE_B(instr)==func->nargs && DECODE_C(instr)==0);
+}
+
+/** Checks whether a call whose result is unused can be removed: the callee may read but not write state,
+    and the call must also be unable to raise on its arguments */
+static bool _optimize_isremovablecall(optimizer *opt, instructionindx iindx) {
+    block *blk = optimize_currentblock(opt);
+    value callee;
+
+    if (!(blk && block_contains(blk, iindx) &&
+          optimize_calltarget(opt, blk, iindx, &callee) &&
+          optimize_calleffect(opt, callee)<=FUNCTIONEFFECT_READONLY)) return false;
+
+    if (MORPHO_ISFUNCTION(callee)) return _optimize_callmatchesarity(optimize_getinstructionat(opt, iindx), MORPHO_GETFUNCTION(callee));
+    return dictionary_get(&opt->validcalls, MORPHO_INTEGER((int) iindx), NULL);
+}
+
+/** Checks whether a call site knows a constant or exact type for some argument that the joined
+    input facts of the callee have lost, so that a specialized copy would see more */
+bool optimize_callsiteismoreprecise(optimizer *opt, objectfunction *func, registerindx argstart, int nargs) {
+    value ix;
+    indx kindx;
+
+    if (_optimize_functionescapes(opt, func) ||
+        _optimize_functionisrecursive(opt, func) ||
+        !dictionary_get(&opt->functioninputindx, MORPHO_OBJECT(func), &ix) ||
+        !MORPHO_ISINTEGER(ix)) return false;
+
+    functioninputinfo *info = &opt->functioninputs.data[MORPHO_GETINTEGERVALUE(ix)];
+
+    for (registerindx i=0; i<nargs && i<func->nargs && i+1<info->input.nreg; i++) {
+        reginfo *joined = &info->input.rinfo[i+1];
+
+        if (optimize_isconstant(opt, argstart+i, &kindx)) {
+            value konst = optimize_getconstant(opt, kindx);
+            if (joined->contents!=REG_CONSTANT ||
+                joined->indx>=func->konst.count ||
+                !MORPHO_ISEQUAL(func->konst.data[joined->indx], konst)) return true;
+        } else if (optimize_hasexacttype(opt, argstart+i)) {
+            if (joined->typeinfo!=REGTYPE_EXACT ||
+                !MORPHO_ISEQUAL(joined->type, optimize_type(opt, argstart+i))) return true;
+        }
+    }
+
+    return false;
+}
+
 static void _optimize_applyinputfact(optimizer *opt, objectfunction *func, registerindx rindx, reginfo *incoming) {
     if (func->klass && rindx==0) {
         reginfo_join(&opt->rlist.rinfo[rindx], incoming);
@@ -488,16 +1137,109 @@ bool optimize_hasuniquetype(optimizer *opt, registerindx r) {
     value type = optimize_type(opt, r);
     regtypeinfo info = optimize_typeinfo(opt, r);
 
-    if (info==REGTYPE_EXACT) return !MORPHO_ISNIL(type);
-    if (info!=REGTYPE_SUBTYPE || !MORPHO_ISCLASS(type)) return false;
+    if (info==REGTYPE_EXACT) return !MORPHO_ISNIL(type);
+    if (info!=REGTYPE_SUBTYPE || !MORPHO_ISCLASS(type)) return false;
+
+    return optimize_classisleaf(MORPHO_GETCLASS(type));
+}
+
+/** Checks if a register has an exact type fact. */
+bool optimize_hasexacttype(optimizer *opt, registerindx r) {
+    return (optimize_typeinfo(opt, r)==REGTYPE_EXACT &&
+            !MORPHO_ISNIL(optimize_type(opt, r)));
+}
+
+/** Checks if the type facts for a register prove it is an instance of a class or one of its subclasses */
+bool optimize_satisfiestype(optimizer *opt, registerindx r, value klass) {
+    value type = optimize_type(opt, r);
+    regtypeinfo info = optimize_typeinfo(opt, r);
+
+    if ((info!=REGTYPE_EXACT && info!=REGTYPE_SUBTYPE) ||
+        !MORPHO_ISCLASS(type) || !MORPHO_ISCLASS(klass)) return false;
+
+    return optimize_classisderivedfrom(opt, MORPHO_GETCLASS(type), MORPHO_GETCLASS(klass));
+}
+
+/** Records the known element count of a list or tuple held in a register */
+void optimize_setlength(optimizer *opt, registerindx r, int length) {
+    reginfolist_setlength(&opt->rlist, r, length);
+}
+
+/** Returns the known element count of a list or tuple held in a register, or REGLENGTH_UNKNOWN */
+int optimize_length(optimizer *opt, registerindx r) {
+    return reginfolist_length(&opt->rlist, r);
+}
+
+/** Forgets the lengths of lists, which code with side effects may resize; tuples are immutable */
+void optimize_invalidatelengths(optimizer *opt) {
+    reginfolist_invalidatelengths(&opt->rlist, typetuple);
+}
+
+/** Records inclusive bounds on the Int value held in a register */
+void optimize_setrange(optimizer *opt, registerindx r, int lo, int hi) {
+    reginfolist_setrange(&opt->rlist, r, lo, hi);
+}
+
+/** Gets bounds on a register that holds an Int, which may be REGRANGE_MIN/REGRANGE_MAX if unbounded */
+bool optimize_intrange(optimizer *opt, registerindx r, int *lo, int *hi) {
+    indx kindx;
+
+    if (optimize_isconstant(opt, r, &kindx)) {
+        value k = optimize_getconstant(opt, kindx);
+        if (!MORPHO_ISINTEGER(k)) return false;
+        *lo = *hi = MORPHO_GETINTEGERVALUE(k);
+        return true;
+    }
+
+    if (optimize_typeinfo(opt, r)!=REGTYPE_EXACT ||
+        !MORPHO_ISEQUAL(optimize_type(opt, r), typeint)) return false;
+
+    reginfolist_range(&opt->rlist, r, lo, hi);
+    return true;
+}
+
+/** Checks whether indexing the object in obj with the index in ix is proven to be in range */
+bool optimize_isinbounds(optimizer *opt, registerindx obj, registerindx ix) {
+    int length = optimize_length(opt, obj), lo, hi;
+
+    return (length!=REGLENGTH_UNKNOWN &&
+            optimize_intrange(opt, ix, &lo, &hi) &&
+            lo>=0 && hi<length);
+}
+
+/** Records whether the current lix/lixl instruction is proven to be in range, so that it may be deleted if dead */
+void optimize_markaccess(optimizer *opt, bool inbounds) {
+    if (opt->pc<0 || opt->pc>=opt->prog->code.count ||
+        opt->prog->code.data[opt->pc]!=opt->current) return; // Instructions awaiting insertion have no index yet
+
+    value key = MORPHO_INTEGER((int) opt->pc);
+    if (inbounds) dictionary_insert(&opt->inboundsaccesses, key, MORPHO_NIL);
+    else dictionary_remove(&opt->inboundsaccesses, key);
+}
+
+/** Checks whether every argument of a call to a builtin is proven to have the type its signature declares */
+bool optimize_builtinargsarevalid(optimizer *opt, value callable, registerindx argstart, int nargs, int nopt) {
+    value type;
+
+    if (!MORPHO_ISBUILTINFUNCTION(callable) || nargs==0 || nopt!=0) return false;
+    signature *sig = &MORPHO_GETBUILTINFUNCTION(callable)->sig;
+    if (signature_getparamtype(sig, nargs, &type)) return false;
 
-    return optimize_classisleaf(MORPHO_GETCLASS(type));
+    for (int i=0; i<nargs; i++) {
+        if (!signature_getparamtype(sig, i, &type) ||
+            !optimize_satisfiestype(opt, argstart+i, type)) return false;
+    }
+    return true;
 }
 
-/** Checks if a register has an exact type fact. */
-bool optimize_hasexacttype(optimizer *opt, registerindx r) {
-    return (optimize_typeinfo(opt, r)==REGTYPE_EXACT &&
-            !MORPHO_ISNIL(optimize_type(opt, r)));
+/** Records whether the current call to a builtin is proven valid, so that it may be deleted if dead */
+void optimize_markcall(optimizer *opt, bool valid) {
+    if (opt->pc<0 || opt->pc>=opt->prog->code.count ||
+        opt->prog->code.data[opt->pc]!=opt->current) return; // Instructions awaiting insertion have no index yet
+
+    value key = MORPHO_INTEGER((int) opt->pc);
+    if (valid) dictionary_insert(&opt->validcalls, key, MORPHO_NIL);
+    else dictionary_remove(&opt->validcalls, key);
 }
 
 /** Checks if a register is overwritten between start and the current instruction */
@@ -514,6 +1256,127 @@ bool optimize_isoverwritten(optimizer *opt, registerindx rindx, instructionindx
     return false;
 }
 
+/** Checks whether register r is written by any instruction in [start, end), including argument slots clobbered by calls */
+bool optimize_isclobberedbetween(optimizer *opt, instructionindx start, instructionindx end, registerindx r) {
+    for (instructionindx i=start; i<end; i++) {
+        instruction instr = optimize_getinstructionat(opt, i);
+        instruction op = DECODE_OP(instr);
+        registerindx overwrites;
+
+        if (op==OP_CALL || op==OP_INVOKE || op==OP_METHOD) {
+            registerindx a = DECODE_A(instr);
+            if (r>=a && r<=a+DECODE_B(instr)+2*DECODE_C(instr)+1) return true;
+        } else if (opcode_overwritesforinstruction(instr, &overwrites) && overwrites==r) return true;
+    }
+    return false;
+}
+
+/* -------------------------------------
+ * Closures
+ * ------------------------------------- */
+
+/** Checks if every write to register r in a function loads the constant kindx, so that a capture of r always sees it */
+bool optimize_isinvariantconstant(optimizer *opt, objectfunction *func, registerindx r, indx kindx) {
+    for (int j=0; j<opt->graph.count; j++) {
+        block *blk = &opt->graph.data[j];
+        if (blk->func!=func || !optimize_blockisreachable(opt, blk)) continue;
+
+        for (instructionindx i=blk->start; i<=blk->end; i++) {
+            instruction instr = optimize_getinstructionat(opt, i);
+            instruction op = DECODE_OP(instr);
+
+            if (op==OP_INSERT || op==OP_INSERT_RESTART) return false;
+            if (op==OP_LCT && DECODE_A(instr)==r && DECODE_Bx(instr)==kindx) continue;
+            if (optimize_isclobberedbetween(opt, i, i+1, r)) return false;
+        }
+    }
+    return true;
+}
+
+/** Checks if a function, or any closure it creates, may write its upvalue uindx */
+bool optimize_writesupvalue(optimizer *opt, objectfunction *func, indx uindx) {
+    for (unsigned int p=0; p<func->prototype.count; p++) {
+        varray_upvalue *prototype = &func->prototype.data[p];
+        for (unsigned int i=0; i<prototype->count; i++) {
+            if (!prototype->data[i].islocal && prototype->data[i].reg==uindx) return true;
+        }
+    }
+
+    for (int j=0; j<opt->graph.count; j++) {
+        block *blk = &opt->graph.data[j];
+        if (blk->func!=func) continue;
+
+        for (instructionindx i=blk->start; i<=blk->end; i++) {
+            instruction instr = optimize_getinstructionat(opt, i);
+            if (DECODE_OP(instr)==OP_SUP && DECODE_A(instr)==uindx) return true;
+        }
+    }
+    return false;
+}
+
+/** Rewrites every load of upvalue uindx in a function into a load of a constant; returns the number of loads rewritten */
+int optimize_bindupvalue(optimizer *opt, objectfunction *func, indx uindx, value val) {
+    indx kindx;
+    int n=0;
+
+    for (int j=0; j<opt->graph.count; j++) {
+        block *blk = &opt->graph.data[j];
+        if (blk->func!=func) continue;
+
+        for (instructionindx i=blk->start; i<=blk->end; i++) {
+            instruction instr = optimize_getinstructionat(opt, i);
+            if (DECODE_OP(instr)!=OP_LUP || DECODE_B(instr)!=uindx) continue;
+
+            if (!n && !_optimize_addconstanttofunction(opt, func, val, &kindx)) return n;
+            optimize_replaceinstructionat(opt, i, ENCODE_LONG(OP_LCT, DECODE_A(instr), kindx));
+            n++;
+        }
+    }
+    return n;
+}
+
+/** Checks if any closure created by a function captures a register at or above r */
+bool optimize_capturesfrom(optimizer *opt, objectfunction *func, registerindx r) {
+    for (int j=0; j<opt->graph.count; j++) {
+        block *blk = &opt->graph.data[j];
+        if (blk->func!=func || !optimize_blockisreachable(opt, blk)) continue;
+
+        for (instructionindx i=blk->start; i<=blk->end; i++) {
+            instruction instr = optimize_getinstructionat(opt, i);
+            instruction op = DECODE_OP(instr);
+            if (op==OP_INSERT || op==OP_INSERT_RESTART) return true;
+            if (op!=OP_CLOSURE) continue;
+
+            varray_upvalue *prototype = &func->prototype.data[DECODE_B(instr)];
+            for (unsigned int k=0; k<prototype->count; k++) {
+                if (prototype->data[k].islocal && prototype->data[k].reg>=r) return true;
+            }
+        }
+    }
+    return false;
+}
+
+/** Checks if a closure created by a function from a prototype other than p captures register r */
+bool optimize_capturedbyother(optimizer *opt, objectfunction *func, unsigned int p, registerindx r) {
+    for (int j=0; j<opt->graph.count; j++) {
+        block *blk = &opt->graph.data[j];
+        if (blk->func!=func || !optimize_blockisreachable(opt, blk)) continue;
+
+        for (instructionindx i=blk->start; i<=blk->end; i++) {
+            instruction instr = optimize_getinstructionat(opt, i);
+            instruction op = DECODE_OP(instr);
+            if (op==OP_INSERT || op==OP_INSERT_RESTART) return true;
+            if (op!=OP_CLOSURE || DECODE_B(instr)==p) continue;
+
+            varray_upvalue *prototype = &func->prototype.data[DECODE_B(instr)];
+            for (unsigned int k=0; k<prototype->count; k++) {
+                if (prototype->data[k].islocal && prototype->data[k].reg==r) return true;
+            }
+        }
+    }
+    return false;
+}
+
 typedef struct {
     registerindx r;
     bool isused;
@@ -641,6 +1504,16 @@ void optimize_insertinstructionswithrestart(optimizer *opt, int n, instruction *
     optimize_replaceinstruction(opt, ENCODE_LONG(restart ? OP_INSERT_RESTART : OP_INSERT, n, start));
 }
 
+/** Queues a sequence of instructions to replace a later instruction of the current block; they are
+    expanded together with the current instruction, which must also become an insertion */
+void optimize_insertinstructionsafter(optimizer *opt, instructionindx iindx, int n, instruction *instr) {
+    instructionindx start = opt->insertions.count;
+    varray_instructionadd(&opt->insertions, instr, n);
+    varray_instructionwrite(&opt->insertions, ENCODE_BYTE(OP_END));
+
+    optimize_replaceinstructionat(opt, iindx, ENCODE_LONG(OP_INSERT, n, start));
+}
+
 /** Replaces the current instruction with LCT r, and a given constant */
 bool optimize_replacewithloadconstant(optimizer *opt, registerindx r, value konst) {
     // Add the constant to the constant table
@@ -669,7 +1542,10 @@ bool optimize_deleteinstruction(optimizer *opt, instructionindx indx) {
     opcodeflags flags = opcode_getflags(DECODE_OP(instr));
     
     // Check for instructions that generic dead-code elimination must not erase.
-    if (flags & OPCODE_NODELETE) return false; // Todo: Check whether some protected instructions could still be safe.
+    if ((flags & OPCODE_NODELETE) &&
+        !(DECODE_OP(instr)==OP_CALL && _optimize_isremovablecall(opt, indx)) &&
+        !((DECODE_OP(instr)==OP_LIX || DECODE_OP(instr)==OP_LIXL) &&
+          dictionary_get(&opt->inboundsaccesses, MORPHO_INTEGER((int) indx), NULL))) return false;
     
     optimize_replaceinstructionat(opt, indx, ENCODE_BYTE(OP_NOP));
     return true;
@@ -1315,6 +2191,24 @@ void optimize_usageforinsertion(optimizer *opt) {
     }
 }
 
+/** Checks if the current instruction may raise an error to a handler of the current block */
+static bool _optimize_raisestohandler(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    instruction op = DECODE_OP(instr);
+
+    if (!opt->currentblk ||
+        !block_hashandlers(opt->currentblk) ||
+        !(opcode_getflags(op) & OPCODE_MAYRAISE)) return false;
+
+    // Arithmetic and ordering on numbers cannot raise
+    if ((op>=OP_ADD && op<=OP_POW) || op==OP_LT || op==OP_LE) {
+        return !(_isnumerictype(optimize_type(opt, DECODE_B(instr))) &&
+                 _isnumerictype(optimize_type(opt, DECODE_C(instr))));
+    }
+
+    return true;
+}
+
 /** Updates reginfo usage information based on the opcode */
 void optimize_usage(optimizer *opt) {
     instruction instr = optimize_getinstruction(opt);
@@ -1322,6 +2216,11 @@ void optimize_usage(optimizer *opt) {
     if (op!=OP_INSERT && op!=OP_INSERT_RESTART) {
         opcode_usageforinstruction(opt->currentblk, instr, _optusagefn, &opt->rlist);
     } else optimize_usageforinsertion(opt);
+
+    // A handler may read any register, so stores before a raising point stay live
+    if (_optimize_raisestohandler(opt)) {
+        for (registerindx r=0; r<opt->rlist.nreg; r++) reginfolist_incread(&opt->rlist, r);
+    }
 }
 
 /** Updates reginfo tracking information for an insertion */
@@ -1333,6 +2232,7 @@ void optimize_trackforinsertion(optimizer *opt) {
     for (int i=0; i<n; i++) {
         instruction iinstr = opt->insertions.data[start+i];
         opt->current=iinstr; // Patch in the inserted instruction so that the tracking fn gets it
+        _optimize_updateavailable(opt, iinstr);
         opcodetrackingfn trackingfn = opcode_gettrackingfn(DECODE_OP(iinstr));
         if (trackingfn) trackingfn(opt);
     }
@@ -1344,6 +2244,8 @@ void optimize_trackforinsertion(optimizer *opt) {
 void optimize_track(optimizer *opt) {
     instruction op=DECODE_OP(opt->current);
     if (op!=OP_INSERT && op!=OP_INSERT_RESTART) {
+        optimize_raiseeffect(opt, _optimize_instructioneffect(opt, opt->current));
+        _optimize_updateavailable(opt, opt->current);
         opcodetrackingfn trackingfn = opcode_gettrackingfn(DECODE_OP(opt->current));
         if (trackingfn) trackingfn(opt);
     } else {
@@ -1453,14 +2355,11 @@ void optimize_repairtakenconditionalbranch(optimizer *opt, instruction instr) {
     _repairconditionalbranch(opt, instr, false);
 }
 
-bool _checkdestusage(optimizer *opt, block *blk, registerindx rindx, dictionary *checked) {
-    blockindx blkindx;
-    if (!cfgraph_findindx(&opt->graph, blk, &blkindx)) return false;
-    
-    dictionary_insert(checked, MORPHO_INTEGER(blkindx), MORPHO_NIL); // Mark this dictionary as checked
-    
-    for (int i=0; i<blk->dest.capacity; i++) {
-        value key = blk->dest.contents[i].key;
+bool _checkdestusage(optimizer *opt, block *blk, registerindx rindx, dictionary *checked);
+
+static bool _checkdestusagein(optimizer *opt, dictionary *dests, registerindx rindx, dictionary *checked) {
+    for (int i=0; i<dests->capacity; i++) {
+        value key = dests->contents[i].key;
         block *dest;
         
         if (MORPHO_ISINTEGER(key) &&
@@ -1477,6 +2376,17 @@ bool _checkdestusage(optimizer *opt, block *blk, registerindx rindx, dictionary
     return false;
 }
 
+bool _checkdestusage(optimizer *opt, block *blk, registerindx rindx, dictionary *checked) {
+    blockindx blkindx;
+    if (!cfgraph_findindx(&opt->graph, blk, &blkindx)) return false;
+    
+    dictionary_insert(checked, MORPHO_INTEGER(blkindx), MORPHO_NIL); // Mark this dictionary as checked
+    
+    // Handlers are successors too, reached from any point that raises
+    return (_checkdestusagein(opt, &blk->dest, rindx, checked) ||
+            _checkdestusagein(opt, &blk->handlers, rindx, checked));
+}
+
 /** Checks usage of a register by subsequent blocks; returns true if it's used */
 bool optimize_checkdestusage(optimizer *opt, block *blk, registerindx rindx) {
     dictionary checked;
@@ -1486,18 +2396,16 @@ bool optimize_checkdestusage(optimizer *opt, block *blk, registerindx rindx) {
     return success; 
 }
 
-static bool _isdeadstoresafearithmetictype(value type) {
-    return (MORPHO_ISEQUAL(type, typeint) ||
-            MORPHO_ISEQUAL(type, typefloat));
-}
-
 bool optimize_candeletedeadstore(optimizer *opt, instruction instr, registerindx r) {
     instruction op = DECODE_OP(instr);
     
     if (op==OP_NOP || op==OP_MOV || op==OP_LCT) return true;
+    if (op==OP_CALL) return (r==DECODE_A(instr)); // optimize_deleteinstruction checks the callee's effects
+    if (op==OP_LIX) return (r==DECODE_B(instr)); // ... and whether the access was proven in range
+    if (op==OP_LIXL) return (r==DECODE_A(instr));
     if (op<OP_ADD || op>OP_POW) return false;
     
-    return _isdeadstoresafearithmetictype(optimize_type(opt, r));
+    return _isnumerictype(optimize_type(opt, r));
 }
 
 static bool _ispreservedentryregister(objectfunction *func, registerindx r) {
@@ -1600,46 +2508,343 @@ static void _shiftblockindices(optimizer *opt, block *blk, int ninsert) {
             b->end+=ninsert;
         }
     }
-}
+}
+
+static void _retargetbranchesafterinsertion(optimizer *opt, block *blk, instructionindx oldend,
+                                            int ninsert, instructionindx *oldtonew,
+                                            instructionindx *newtoold) {
+    varray_instruction *code = &opt->prog->code;
+    
+    for (instructionindx i=0; i<code->count; i++) {
+        instruction instr = code->data[i];
+        opcodeflags flags = opcode_getflags(DECODE_OP(instr));
+        
+        if (!(flags & OPCODE_BRANCH)) continue;
+        
+        instructionindx oldsrc = _oldinsertionindex(i, blk->start, blk->end, ninsert, newtoold);
+        if (oldsrc==INSTRUCTIONINDX_EMPTY) continue;
+        
+        instructionindx oldtarget = oldsrc+1+DECODE_sBx(instr);
+        instructionindx newtarget = _remapinsertionindex(oldtarget, blk->start, oldend, ninsert, oldtonew);
+        int newoffset = (int) (newtarget-(i+1));
+
+        if (opt->verbose) {
+            printf("Retarget branch in block [%td, %td]: pc=%td oldsrc=%td oldtarget=%td newtarget=%td oldoff=%d newoff=%d op=%u\n",
+                   blk->start,
+                   oldend,
+                   i,
+                   oldsrc,
+                   oldtarget,
+                   newtarget,
+                   DECODE_sBx(instr),
+                   newoffset,
+                   DECODE_OP(instr));
+        }
+        
+        if (newoffset!=DECODE_sBx(instr)) {
+            if (opt->verbose) {
+                printf("  rewrite branch at %td -> target %td (offset %d)\n", i, newtarget, newoffset);
+            }
+            code->data[i] = ENCODE_LONG(DECODE_OP(instr), DECODE_A(instr), newoffset);
+        }
+    }
+}
+
+/* -------------------------------------
+ * Splitting blocks at inserted control flow
+ * ------------------------------------- */
+
+/** Renumbers the block index keys of a dictionary after n blocks are opened following block after */
+static void _renumberblockdictionary(dictionary *dict, blockindx after, int n) {
+    dictionary out;
+    dictionary_init(&out);
+
+    for (int i=0; i<dict->capacity; i++) {
+        value key = dict->contents[i].key;
+        if (!MORPHO_ISINTEGER(key)) continue;
+
+        blockindx k = MORPHO_GETINTEGERVALUE(key);
+        dictionary_insert(&out, MORPHO_INTEGER((int) (k>after ? k+n : k)), dict->contents[i].val);
+    }
+
+    dictionary_clear(dict);
+    *dict = out;
+}
+
+static blockindx _renumberblockindx(blockindx b, blockindx after, int n) {
+    return ((b!=BLOCKINDX_EMPTY && b>after) ? b+n : b);
+}
+
+/** Opens n empty block slots following block after, renumbering all references to later blocks */
+static bool _optimize_openblocks(optimizer *opt, blockindx after, int n) {
+    cfgraph *graph = &opt->graph;
+    blockindx current = (opt->currentblk ? (blockindx) (opt->currentblk - graph->data) : BLOCKINDX_EMPTY);
+
+    for (int i=0; i<graph->count; i++) {
+        block *b = &graph->data[i];
+        _renumberblockdictionary(&b->dest, after, n);
+        _renumberblockdictionary(&b->src, after, n);
+        _renumberblockdictionary(&b->loopsrc, after, n);
+        _renumberblockdictionary(&b->loopblocks, after, n);
+        _renumberblockdictionary(&b->handlers, after, n);
+        _renumberblockdictionary(&b->region, after, n);
+        b->branch = _renumberblockindx(b->branch, after, n);
+        b->fallthrough = _renumberblockindx(b->fallthrough, after, n);
+    }
+
+    if (!varray_blockresize(graph, n)) return false;
+
+    int nmove = graph->count - (after+1);
+    if (nmove) memmove(&graph->data[after+1+n], &graph->data[after+1], sizeof(block)*nmove);
+    graph->count+=n;
+
+    if (current!=BLOCKINDX_EMPTY) opt->currentblk = &graph->data[_renumberblockindx(current, after, n)];
+    opt->reachabledirty=true;
+
+    return true;
+}
+
+/** Connects a block to its successors from its final instruction, as the graph builder does */
+static void _optimize_connectblock(optimizer *opt, blockindx bindx) {
+    cfgraph *graph = &opt->graph;
+    block *blk = &graph->data[bindx];
+    instruction last = optimize_getinstructionat(opt, blk->end);
+    opcodeflags flags = opcode_getflags(DECODE_OP(last));
+    blockindx dest;
+
+    if (flags & OPCODE_TERMINATING) return;
+
+    if (flags & OPCODE_BRANCH) {
+        instructionindx target = blk->end+1+DECODE_sBx(last);
+        if (cfgraph_findblockindx(graph, target, &dest)) {
+            cfgraph_connect(blk, dest, target, graph);
+            if (flags & OPCODE_NEWBLOCKAFTER) blk->branch=dest;
+        }
+        if (!(flags & OPCODE_NEWBLOCKAFTER)) return;
+    }
+
+    if (cfgraph_findblockindx(graph, blk->end+1, &dest)) {
+        cfgraph_connect(blk, dest, blk->end+1, graph);
+        if (flags & OPCODE_NEWBLOCKAFTER) blk->fallthrough=dest;
+    }
+}
+
+/** Inserted code may carry its own control flow (e.g. an inlined multi-block callee). Splits such a
+    block into basic blocks at every leader it contains and wires them into the graph. */
+static bool _optimize_splitinsertedcontrolflow(optimizer *opt, block *blk) {
+    cfgraph *graph = &opt->graph;
+    blockindx bindx;
+    if (!cfgraph_findindx(graph, blk, &bindx)) return false;
+
+    instructionindx start = blk->start, end = blk->end, len = end-start+1;
+    bool leader[len];
+    int nsplit=0;
+
+    for (instructionindx i=0; i<len; i++) leader[i]=false;
+
+    for (instructionindx i=start; i<=end; i++) {
+        instruction instr = optimize_getinstructionat(opt, i);
+        opcodeflags flags = opcode_getflags(DECODE_OP(instr));
+
+        if ((flags & OPCODE_ENDSBLOCK) && i<end) leader[i+1-start]=true;
+        if (flags & OPCODE_BRANCH) {
+            instructionindx target = i+1+DECODE_sBx(instr);
+            if (target>start && target<=end) leader[target-start]=true;
+        }
+    }
+
+    for (instructionindx i=1; i<len; i++) if (leader[i]) nsplit++;
+    if (!nsplit) return true;
+
+    if (!_optimize_openblocks(opt, bindx, nsplit)) return false;
+    blk = &graph->data[bindx];
+
+    // The final piece inherits the original successors
+    blockindx lastindx = bindx+nsplit;
+    block *last = &graph->data[lastindx];
+    objectfunction *func = blk->func;
+
+    instructionindx pstart=end;
+    for (instructionindx i=len-1; i>0; i--) if (leader[i]) { pstart=start+i; break; }
+
+    block_init(last, func, pstart);
+    last->end=end;
+    last->ostart=INSTRUCTIONINDX_EMPTY;
+    dictionary_clear(&last->dest);
+    last->dest=blk->dest;
+    dictionary_init(&blk->dest);
+    last->branch=blk->branch;
+    last->fallthrough=blk->fallthrough;
+    blk->branch=BLOCKINDX_EMPTY;
+    blk->fallthrough=BLOCKINDX_EMPTY;
+
+    for (int i=0; i<last->dest.capacity; i++) {
+        value key = last->dest.contents[i].key;
+        block *dest;
+        if (!MORPHO_ISINTEGER(key) ||
+            !cfgraph_indx(graph, MORPHO_GETINTEGERVALUE(key), &dest)) continue;
+        dictionary_remove(&dest->src, MORPHO_INTEGER((int) bindx));
+        block_setsource(dest, lastindx);
+    }
+
+    // Lay out the intermediate pieces
+    blockindx k=bindx;
+    for (instructionindx i=1; i<len; i++) {
+        if (!leader[i]) continue;
+        graph->data[k].end=start+i-1;
+        k++;
+        if (k<lastindx) {
+            block_init(&graph->data[k], func, start+i);
+            graph->data[k].ostart=INSTRUCTIONINDX_EMPTY;
+        }
+    }
+
+    for (blockindx j=bindx; j<lastindx; j++) _optimize_connectblock(opt, j);
+    for (blockindx j=bindx+1; j<=lastindx; j++) { // Every piece stays within the original's try region
+        for (int i=0; i<graph->data[bindx].handlers.capacity; i++) {
+            value key = graph->data[bindx].handlers.contents[i].key;
+            block *handler;
+            if (!MORPHO_ISINTEGER(key)) continue;
+            block_sethandler(&graph->data[j], MORPHO_GETINTEGERVALUE(key));
+            if (cfgraph_indx(graph, MORPHO_GETINTEGERVALUE(key), &handler)) block_setregionblock(handler, j);
+        }
+    }
+    for (blockindx j=bindx; j<=lastindx; j++) block_computeusage(&graph->data[j], opt->prog->code.data);
+
+    return true;
+}
+
+/* -------------------------------------
+ * Function cloning
+ * ------------------------------------- */
+
+static bool _optimize_isclonable(optimizer *opt, objectfunction *func) {
+    value type;
+
+    if (func->klass || func->nopt!=0) return false;
+    for (int i=0; i<func->nargs; i++) { // The clone is created without a signature
+        if (signature_getparamtype(&func->sig, i, &type) && !MORPHO_ISNIL(type)) return false;
+    }
+
+    // Call-site facts are joined per pass, so clone a function at most once per pass
+    value pass;
+    return !(dictionary_get(&opt->clonedfunctions, MORPHO_OBJECT(func), &pass) &&
+             MORPHO_ISINTEGER(pass) && MORPHO_GETINTEGERVALUE(pass)==opt->pass);
+}
+
+/** Creates a copy of a function whose code and blocks are appended to the program and graph.
+    The copy is bound to the program; the caller is responsible for referencing it. */
+bool optimize_clonefunction(optimizer *opt, objectfunction *func, objectfunction **out) {
+    varray_instruction *code = &opt->prog->code;
+    blockindx current = (opt->currentblk ? (blockindx) (opt->currentblk - opt->graph.data) : BLOCKINDX_EMPTY);
+    int nblocks=0, ninstr=0;
+
+    if (!_optimize_isclonable(opt, func)) return false;
+
+    for (int i=0; i<opt->graph.count; i++) {
+        block *blk = &opt->graph.data[i];
+        if (blk->func==func && optimize_blockisreachable(opt, blk)) nblocks++;
+    }
+    if (!nblocks) return false;
+
+    blockindx blocks[nblocks];
+    for (int i=0, k=0; i<opt->graph.count; i++) {
+        block *blk = &opt->graph.data[i];
+        if (blk->func==func && optimize_blockisreachable(opt, blk)) blocks[k++]=i;
+    }
+
+    instructionindx base = opt->graph.data[blocks[0]].start, range = opt->graph.data[blocks[nblocks-1]].end - base + 1;
+    if (base!=func->entry) return false;
+
+    for (int j=0; j<nblocks; j++) {
+        block *blk = &opt->graph.data[blocks[j]];
+
+        for (instructionindx i=blk->start; i<=blk->end; i++) {
+            instruction op = DECODE_OP(optimize_getinstructionat(opt, i));
+            if (op==OP_CLOSURE || op==OP_LUP || op==OP_SUP || op==OP_CLOSEUP || op==OP_END ||
+                op==OP_PUSHERR || op==OP_POPERR || op==OP_INSERT || op==OP_INSERT_RESTART) return false;
+            if (op!=OP_NOP) ninstr++;
+        }
+
+        // Blocks that fall through must remain adjacent once copied
+        opcodeflags flags = opcode_getflags(DECODE_OP(optimize_getinstructionat(opt, blk->end)));
+        if ((flags & OPCODE_TERMINATING) || ((flags & OPCODE_BRANCH) && !(flags & OPCODE_NEWBLOCKAFTER))) continue;
+        if (j==nblocks-1 || opt->graph.data[blocks[j+1]].start!=blk->end+1) return false;
+    }
+
+    if (opt->nclonedinstructions+ninstr>OPTIMIZER_CLONE_BUDGET) return false;
+
+    // Map old to new positions; blocks of the function that aren't copied leave gaps
+    instructionindx newpos[range];
+    for (instructionindx i=0; i<range; i++) newpos[i]=INSTRUCTIONINDX_EMPTY;
+    for (int j=0, k=0; j<nblocks; j++) {
+        block *blk = &opt->graph.data[blocks[j]];
+        for (instructionindx i=blk->start; i<=blk->end; i++) newpos[i-base]=code->count+(k++);
+    }
+
+    // Every branch must land in a copied block
+    for (int j=0; j<nblocks; j++) {
+        block *blk = &opt->graph.data[blocks[j]];
+        for (instructionindx i=blk->start; i<=blk->end; i++) {
+            instruction instr = optimize_getinstructionat(opt, i);
+            if (!(opcode_getflags(DECODE_OP(instr)) & OPCODE_BRANCH)) continue;
+
+            instructionindx target = i+1+DECODE_sBx(instr);
+            if (target<base || target>=base+range || newpos[target-base]==INSTRUCTIONINDX_EMPTY) return false;
+        }
+    }
+
+    objectfunction *clone = object_newfunction(code->count, func->name, func->parent, func->nargs);
+    if (!clone) return false;
+    clone->nregs=func->nregs;
+    varray_valueadd(&clone->konst, func->konst.data, func->konst.count);
+    program_bindobject(opt->prog, (object *) clone);
+
+    // Copy the code, then retarget branches through the old to new index map
+    for (int j=0; j<nblocks; j++) {
+        block *blk = &opt->graph.data[blocks[j]];
+        for (instructionindx i=blk->start; i<=blk->end; i++) {
+            varray_instructionwrite(code, optimize_getinstructionat(opt, i));
+        }
+    }
+
+    for (int j=0; j<nblocks; j++) {
+        block *blk = &opt->graph.data[blocks[j]];
+        for (instructionindx i=blk->start; i<=blk->end; i++) {
+            instruction instr = optimize_getinstructionat(opt, i);
+            if (!(opcode_getflags(DECODE_OP(instr)) & OPCODE_BRANCH)) continue;
+
+            instructionindx target = newpos[i+1+DECODE_sBx(instr)-base];
+            code->data[newpos[i-base]] = ENCODE_LONG(DECODE_OP(instr), DECODE_A(instr), target-newpos[i-base]-1);
+        }
+    }
 
-static void _retargetbranchesafterinsertion(optimizer *opt, block *blk, instructionindx oldend,
-                                            int ninsert, instructionindx *oldtonew,
-                                            instructionindx *newtoold) {
-    varray_instruction *code = &opt->prog->code;
-    
-    for (instructionindx i=0; i<code->count; i++) {
-        instruction instr = code->data[i];
-        opcodeflags flags = opcode_getflags(DECODE_OP(instr));
-        
-        if (!(flags & OPCODE_BRANCH)) continue;
-        
-        instructionindx oldsrc = _oldinsertionindex(i, blk->start, blk->end, ninsert, newtoold);
-        if (oldsrc==INSTRUCTIONINDX_EMPTY) continue;
-        
-        instructionindx oldtarget = oldsrc+1+DECODE_sBx(instr);
-        instructionindx newtarget = _remapinsertionindex(oldtarget, blk->start, oldend, ninsert, oldtonew);
-        int newoffset = (int) (newtarget-(i+1));
+    // Append matching blocks; they sort after every existing block
+    blockindx first = opt->graph.count;
+    for (int j=0; j<nblocks; j++) {
+        block *blk = &opt->graph.data[blocks[j]], nb;
+        instructionindx start = newpos[blk->start-base], end = newpos[blk->end-base];
+
+        block_init(&nb, clone, start);
+        nb.end=end;
+        nb.ostart=INSTRUCTIONINDX_EMPTY;
+        nb.isentry=(j==0);
+        varray_blockwrite(&opt->graph, nb);
+    }
 
-        if (opt->verbose) {
-            printf("Retarget branch in block [%td, %td]: pc=%td oldsrc=%td oldtarget=%td newtarget=%td oldoff=%d newoff=%d op=%u\n",
-                   blk->start,
-                   oldend,
-                   i,
-                   oldsrc,
-                   oldtarget,
-                   newtarget,
-                   DECODE_sBx(instr),
-                   newoffset,
-                   DECODE_OP(instr));
-        }
-        
-        if (newoffset!=DECODE_sBx(instr)) {
-            if (opt->verbose) {
-                printf("  rewrite branch at %td -> target %td (offset %d)\n", i, newtarget, newoffset);
-            }
-            code->data[i] = ENCODE_LONG(DECODE_OP(instr), DECODE_A(instr), newoffset);
-        }
+    if (current!=BLOCKINDX_EMPTY) opt->currentblk=&opt->graph.data[current];
+
+    for (blockindx j=first; j<opt->graph.count; j++) {
+        _optimize_connectblock(opt, j);
+        block_computeusage(&opt->graph.data[j], code->data);
     }
+
+    dictionary_insert(&opt->clonedfunctions, MORPHO_OBJECT(func), MORPHO_INTEGER(opt->pass));
+    opt->nclonedinstructions+=ninstr;
+    opt->reachabledirty=true;
+
+    *out = clone;
+    return true;
 }
 
 /** Rebuilds a block inserting inserted code */
@@ -1695,12 +2900,15 @@ bool optimize_processinsertions(optimizer *opt, block *blk) {
     _shiftblockindices(opt, blk, ninsert);
     
     _retargetbranchesafterinsertion(opt, blk, oldend, ninsert, oldtonew, newtoold);
+    if (!_optimize_splitinsertedcontrolflow(opt, blk)) return false;
+    blk = opt->currentblk;
 
     /* The block contents have been rewritten in-place, so any cached input/output
        facts for this block are no longer trustworthy. Force the next dataflow pass
        to recompute them from predecessors instead of comparing against stale facts. */
     reginfolist_wipe(&blk->rin, blk->func->nregs);
     reginfolist_wipe(&blk->rout, blk->func->nregs);
+    reginfolist_wipe(&blk->rexc, blk->func->nregs);
     
     if (opt->verbose) {
         printf("Expanded block [%ti - %ti]\n", blk->start, blk->end);
@@ -1714,6 +2922,57 @@ bool optimize_processinsertions(optimizer *opt, block *blk) {
     return true;
 }
 
+/** Checks whether the instruction at iindx of a block that follows the current one can be expanded */
+bool optimize_canexpandat(optimizer *opt, block *blk, instructionindx iindx) {
+    instruction op = DECODE_OP(optimize_getinstructionat(opt, iindx));
+
+    return (opt->insertions.count==0 && blk->start>opt->currentblk->end && block_contains(blk, iindx) &&
+            op!=OP_INSERT && op!=OP_INSERT_RESTART &&
+            !(opcode_getflags(op) & OPCODE_BRANCH_TABLE));
+}
+
+/** Replaces the instruction at iindx of a block that follows the current one with a sequence of
+    instructions, expanding them immediately; branches among them must already be encoded for their final position */
+bool optimize_insertinstructionsat(optimizer *opt, block *blk, instructionindx iindx, int n, instruction *instr) {
+    block *current = opt->currentblk;
+
+    if (!optimize_canexpandat(opt, blk, iindx)) return false;
+
+    instructionindx start = opt->insertions.count;
+    varray_instructionadd(&opt->insertions, instr, n);
+    varray_instructionwrite(&opt->insertions, ENCODE_BYTE(OP_END));
+    optimize_replaceinstructionat(opt, iindx, ENCODE_LONG(OP_INSERT, n, start));
+
+    opt->currentblk=blk;
+    bool success=optimize_processinsertions(opt, blk);
+    opt->currentblk=current;
+    if (success) block_computeusage(blk, opt->prog->code.data);
+
+    return success;
+}
+
+/** Checks whether instructions can be prepended to a block that follows the current one */
+bool optimize_canprependinstructions(optimizer *opt, block *blk) {
+    return optimize_canexpandat(opt, blk, blk->start);
+}
+
+/** Expands instructions at the start of a block following the current one immediately; a branch
+    leading the block moves after them, so its offset is corrected if its target does not move */
+bool optimize_prependinstructions(optimizer *opt, block *blk, int n, instruction *instr) {
+    instruction first = optimize_getinstructionat(opt, blk->start);
+    instruction op = DECODE_OP(first);
+    instruction expanded[n+1];
+
+    if ((opcode_getflags(op) & OPCODE_BRANCH) && DECODE_sBx(first)<0) {
+        first = ENCODE_LONG(op, DECODE_A(first), DECODE_sBx(first)-n);
+    }
+
+    for (int i=0; i<n; i++) expanded[i]=instr[i];
+    expanded[n]=first;
+
+    return optimize_insertinstructionsat(opt, blk, blk->start, n+1, expanded);
+}
+
 /** Sets the contents of registers from knowledge of the function signature */
 void optimize_signature(optimizer *opt) {
     objectfunction *func = optimize_currentblock(opt)->func;
@@ -1772,6 +3031,7 @@ bool optimize_block(optimizer *opt, block *blk) {
             if (strategy_optimizeinstruction(opt, opt->pass)) {
                 optimize_usage(opt); // Conservatively mark anything new as used
             }
+            blk = opt->currentblk; // Cloning a function may move the graph
 
             // Abort if we generated an insertion
             instruction op = DECODE_OP(optimize_getinstruction(opt));
@@ -1798,6 +3058,7 @@ bool optimize_block(optimizer *opt, block *blk) {
             }
 
             if (!optimize_processinsertions(opt, blk)) return false;
+            blk = opt->currentblk; // Splitting inserted control flow may move the graph
 
             if (restart) {
                 /* Re-run the block from the beginning with freshly joined facts so
@@ -1870,6 +3131,11 @@ void optimize_functioninputs_init(optimizer *opt) {
     optimize_clearfunctioninputs(opt);
 }
 
+/** Clears return summaries before each analysis pass. */
+void optimize_functionsummaries_init(optimizer *opt) {
+    optimize_clearsummaries(opt);
+}
+
 /* -------------------------------------
  * Processed labels
  * ------------------------------------- */
@@ -1879,6 +3145,79 @@ void optimize_processedlabels_init(optimizer *opt) {
     optimize_clearprocessedlabels(opt);
 }
 
+/* -------------------------------------
+ * In-bounds accesses
+ * ------------------------------------- */
+
+/** Clears proven in-bounds accesses before each analysis pass, as instruction indices may have moved. */
+void optimize_inboundsaccesses_init(optimizer *opt) {
+    dictionary_clear(&opt->inboundsaccesses);
+    dictionary_init(&opt->inboundsaccesses);
+}
+
+/** Clears proven builtin calls before each analysis pass, for the same reason. */
+void optimize_validcalls_init(optimizer *opt) {
+    dictionary_clear(&opt->validcalls);
+    dictionary_init(&opt->validcalls);
+}
+
+/* -------------------------------------
+ * Try regions
+ * ------------------------------------- */
+
+/** Clears try region membership before each analysis pass. */
+void optimize_tryregions_init(optimizer *opt) {
+    for (int i=0; i<opt->graph.count; i++) {
+        block_clearhandlers(&opt->graph.data[i]);
+    }
+}
+
+/* Walk forward from the body of a try region, recording the handlers of pusherr on every block reached
+   before the matching poperr; nested regions are tracked by depth, and their handlers run at the outer depth. */
+static void _optimize_marktryregion(optimizer *opt, block *pusherr, blockindx curindx, int depth, dictionary *visited) {
+    block *cur;
+
+    if (dictionary_get(visited, MORPHO_INTEGER((int) curindx), NULL) ||
+        !cfgraph_indx(&opt->graph, curindx, &cur) ||
+        cur->func!=pusherr->func) return;
+    dictionary_insert(visited, MORPHO_INTEGER((int) curindx), MORPHO_NIL);
+
+    for (int i=0; i<pusherr->dest.capacity; i++) {
+        value key = pusherr->dest.contents[i].key;
+        block *handler;
+        if (MORPHO_ISINTEGER(key) && MORPHO_GETINTEGERVALUE(key)!=pusherr->fallthrough) {
+            block_sethandler(cur, MORPHO_GETINTEGERVALUE(key));
+            if (cfgraph_indx(&opt->graph, MORPHO_GETINTEGERVALUE(key), &handler)) block_setregionblock(handler, curindx);
+        }
+    }
+
+    instruction op = DECODE_OP(optimize_getinstructionat(opt, cur->end));
+    if (op==OP_POPERR && depth==0) return;
+
+    for (int i=0; i<cur->dest.capacity; i++) {
+        value key = cur->dest.contents[i].key;
+        if (!MORPHO_ISINTEGER(key)) continue;
+
+        blockindx dest = MORPHO_GETINTEGERVALUE(key);
+        int ddepth = depth;
+        if (op==OP_POPERR) ddepth--;
+        else if (op==OP_PUSHERR && dest==cur->fallthrough) ddepth++;
+
+        _optimize_marktryregion(opt, pusherr, dest, ddepth, visited);
+    }
+}
+
+/** Records the handlers of a try region opened by a block on the blocks that lie within it. */
+void optimize_tryregions_visitblock(optimizer *opt, block *blk) {
+    if (DECODE_OP(optimize_getinstructionat(opt, blk->end))!=OP_PUSHERR ||
+        blk->fallthrough==BLOCKINDX_EMPTY) return;
+
+    dictionary visited;
+    dictionary_init(&visited);
+    _optimize_marktryregion(opt, blk, blk->fallthrough, 0, &visited);
+    dictionary_clear(&visited);
+}
+
 /* -------------------------------------
  * Global usage
  * ------------------------------------- */
@@ -1978,6 +3317,27 @@ static bool _loopwrites(optimizer *opt, block *header, registerindx r) {
     return false;
 }
 
+/** Finds the only instruction in a loop that writes register r; fails if there are none or several */
+static bool _loopsinglewrite(optimizer *opt, block *header, registerindx r, instructionindx *out) {
+    int nwrites=0;
+
+    for (int i=0; i<header->loopblocks.capacity; i++) {
+        value key = header->loopblocks.contents[i].key;
+        block *blk;
+
+        if (!MORPHO_ISINTEGER(key) ||
+            !cfgraph_indx(&opt->graph, (blockindx) MORPHO_GETINTEGERVALUE(key), &blk)) continue;
+
+        for (instructionindx j=blk->start; j<=blk->end; j++) {
+            if (!optimize_isclobberedbetween(opt, j, j+1, r)) continue;
+            if (++nwrites>1) return false;
+            *out=j;
+        }
+    }
+
+    return (nwrites==1);
+}
+
 static bool _isintfact(block *blk, reginfo *info) {
     if (info->typeinfo==REGTYPE_EXACT && MORPHO_ISEQUAL(info->type, typeint)) return true;
     if (info->contents!=REG_CONSTANT) return false;
@@ -2041,7 +3401,11 @@ void optimize_loopcandidates_finalize(optimizer *opt) {
 prepass prepasses[] = {
     { optimize_functionstructure_init, optimize_functionstructure_visitblock, NULL, NULL },
     { optimize_functioninputs_init, NULL, NULL, NULL },
+    { optimize_functionsummaries_init, NULL, NULL, NULL },
     { optimize_processedlabels_init, NULL, NULL, NULL },
+    { optimize_inboundsaccesses_init, NULL, NULL, NULL },
+    { optimize_validcalls_init, NULL, NULL, NULL },
+    { optimize_tryregions_init, optimize_tryregions_visitblock, NULL, NULL },
     { optimize_globalusage_init, NULL, globalusagevisitors, NULL },
     { optimize_loopcandidates_init, optimize_loopcandidates_visitblock, NULL, optimize_loopcandidates_finalize },
     { NULL, NULL, NULL, NULL }
@@ -2084,6 +3448,146 @@ void optimize_runprepasses(optimizer *opt) {
  * Dataflow analysis
  * ********************************************************************** */
 
+/* -------------------------------------
+ * Edge refinement
+ * ------------------------------------- */
+
+static int _rangeinc(int v) {
+    return ((v==REGRANGE_MIN || v==REGRANGE_MAX) ? v : v+1);
+}
+
+static int _rangedec(int v) {
+    return ((v==REGRANGE_MIN || v==REGRANGE_MAX) ? v : v-1);
+}
+
+static int _rangemin(int a, int b) {
+    return (a<b ? a : b);
+}
+
+static int _rangemax(int a, int b) {
+    return (a>b ? a : b);
+}
+
+/** Gets the range of a fact known to hold an Int */
+static bool _intfactrange(block *blk, reginfo *info, int *lo, int *hi) {
+    if (info->contents==REG_CONSTANT) {
+        value konst = block_getconstant(blk, info->indx);
+        if (!MORPHO_ISINTEGER(konst)) return false;
+        *lo = *hi = MORPHO_GETINTEGERVALUE(konst);
+        return true;
+    }
+
+    if (info->typeinfo!=REGTYPE_EXACT || !MORPHO_ISEQUAL(info->type, typeint)) return false;
+    *lo=info->lo;
+    *hi=info->hi;
+    return true;
+}
+
+/** Narrows the ranges of the operands of an Int comparison given its outcome */
+static void _refinecomparison(block *blk, reginfolist *facts, instruction cmp, bool outcome) {
+    registerindx x=DECODE_B(cmp), y=DECODE_C(cmp);
+    int xl, xh, yl, yh;
+
+    if (x==y || x>=facts->nreg || y>=facts->nreg ||
+        !_intfactrange(blk, &facts->rinfo[x], &xl, &xh) ||
+        !_intfactrange(blk, &facts->rinfo[y], &yl, &yh)) return;
+
+    int nxl=xl, nxh=xh, nyl=yl, nyh=yh;
+    switch (DECODE_OP(cmp)) {
+        case OP_LT:
+            if (outcome) { nxh=_rangemin(xh, _rangedec(yh)); nyl=_rangemax(yl, _rangeinc(xl)); }
+            else { nxl=_rangemax(xl, yl); nyh=_rangemin(yh, xh); }
+            break;
+        case OP_LE:
+            if (outcome) { nxh=_rangemin(xh, yh); nyl=_rangemax(yl, xl); }
+            else { nxl=_rangemax(xl, _rangeinc(yl)); nyh=_rangemin(yh, _rangedec(xh)); }
+            break;
+        case OP_EQ:
+            if (outcome) { nxl=nyl=_rangemax(xl, yl); nxh=nyh=_rangemin(xh, yh); }
+            break;
+        default:
+            return;
+    }
+
+    if (nxl<=nxh) { facts->rinfo[x].lo=nxl; facts->rinfo[x].hi=nxh; }
+    if (nyl<=nyh) { facts->rinfo[y].lo=nyl; facts->rinfo[y].hi=nyh; }
+}
+
+#define OPTIMIZER_CONDITIONDEPTH 4
+
+/** Records that register x equals the constant held by register y, when equality with that constant implies identity */
+static void _refineequality(block *blk, reginfolist *facts, registerindx x, registerindx y) {
+    reginfo *kinfo = &facts->rinfo[y], *info = &facts->rinfo[x];
+    if (kinfo->contents!=REG_CONSTANT) return;
+
+    value konst = block_getconstant(blk, kinfo->indx);
+    if (!MORPHO_ISNIL(konst)) {
+        // Numeric equality crosses types, so the register must already share the constant's exact type
+        if (!(MORPHO_ISINTEGER(konst) || MORPHO_ISBOOL(konst)) ||
+            info->typeinfo!=REGTYPE_EXACT || !MORPHO_ISEQUAL(info->type, kinfo->type)) return;
+    }
+
+    info->contents=REG_CONSTANT;
+    info->indx=kinfo->indx;
+    info->iindx=INSTRUCTIONINDX_EMPTY;
+    info->type=kinfo->type;
+    info->typeinfo=kinfo->typeinfo;
+    info->lo=kinfo->lo;
+    info->hi=kinfo->hi;
+}
+
+/** Narrows the facts at the end of pred given the outcome of the condition held in register cond just before
+    instruction before; comparisons refine their operands and not is followed back to its operand */
+static void _refinecondition(optimizer *opt, block *pred, reginfolist *facts, registerindx cond, instructionindx before, bool outcome, int depth) {
+    instructionindx src;
+
+    if (depth>OPTIMIZER_CONDITIONDEPTH ||
+        !optimize_findwriter(opt, pred, cond, before, &src)) return;
+
+    instruction instr = optimize_getinstructionat(opt, src);
+    instruction op = DECODE_OP(instr);
+    registerindx x = DECODE_B(instr), y = DECODE_C(instr);
+
+    if (op==OP_NOT) {
+        _refinecondition(opt, pred, facts, x, src, !outcome, depth+1);
+        return;
+    }
+
+    if ((op!=OP_LT && op!=OP_LE && op!=OP_EQ && op!=OP_NEQ) ||
+        x>=facts->nreg || y>=facts->nreg ||
+        optimize_isclobberedbetween(opt, src+1, pred->end, x) ||
+        optimize_isclobberedbetween(opt, src+1, pred->end, y)) return;
+
+    if (op==OP_NEQ) { op=OP_EQ; outcome=!outcome; }
+
+    _refinecomparison(pred, facts, ENCODE(op, DECODE_A(instr), x, y), outcome);
+
+    if (op==OP_EQ && outcome) {
+        _refineequality(pred, facts, x, y);
+        _refineequality(pred, facts, y, x);
+    }
+}
+
+/** Copies the output facts of pred as seen along its edge into blk, refined by the condition that decides a conditional branch */
+static void _edgefacts(optimizer *opt, block *pred, block *blk, reginfolist *out) {
+    instruction br = optimize_getinstructionat(opt, pred->end);
+    instruction op = DECODE_OP(br);
+    blockindx bindx;
+
+    reginfolist_copy(&pred->rout, out);
+
+    if ((op!=OP_BIF && op!=OP_BIFF) ||
+        pred->branch==pred->fallthrough ||
+        !cfgraph_findindx(&opt->graph, blk, &bindx)) return;
+
+    bool taken;
+    if (bindx==pred->branch) taken=true;
+    else if (bindx==pred->fallthrough) taken=false;
+    else return;
+
+    _refinecondition(opt, pred, out, DECODE_A(br), pred->end, (op==OP_BIF ? taken : !taken), 0);
+}
+
 static void _prepareboundaryfact(reginfo *info) {
     info->usage=REGUSE_NONE;
     info->hasalias=false;
@@ -2096,12 +3600,12 @@ static void _prepareboundaryfact(reginfo *info) {
     if (MORPHO_ISNIL(info->type)) info->typeinfo=REGTYPE_UNKNOWN;
 }
 
-static reginfo _resolvejoinfact(int n, block **src, int rindx) {
-    reginfo joined = src[0]->rout.rinfo[rindx];
+static reginfo _resolvejoinfact(int n, reginfolist *facts, int rindx) {
+    reginfo joined = facts[0].rinfo[rindx];
 
     _prepareboundaryfact(&joined);
     for (int k=1; k<n; k++) {
-        reginfo_join(&joined, &src[k]->rout.rinfo[rindx]);
+        reginfo_join(&joined, &facts[k].rinfo[rindx]);
     }
 
     // Register aliases are local facts; drop them conservatively at block boundaries.
@@ -2110,10 +3614,10 @@ static reginfo _resolvejoinfact(int n, block **src, int rindx) {
     return joined;
 }
 
-static void _resolve(int n, block **src, reginfolist *dest) {
+static void _resolve(int n, block **src, reginfolist *facts, reginfolist *dest) {
     for (int i=0; i<dest->nreg; i++) {
         if (_ispreservedentryregister(src[0]->func, i)) continue;
-        dest->rinfo[i]=_resolvejoinfact(n, src, i);
+        dest->rinfo[i]=_resolvejoinfact(n, facts, i);
     }
 }
 
@@ -2121,9 +3625,32 @@ static bool _isloopbackedgepred(block *blk, blockindx srcindx) {
     return dictionary_get(&blk->loopsrc, MORPHO_INTEGER((int) srcindx), NULL);
 }
 
-static void _resolveloopheader(optimizer *opt, block *blk, int nsrc, block **src, reginfolist *dest) {
-    block *entrypred[nsrc];
-    block *backpred[nsrc];
+/* Determine whether a loop update recognized by _isintpreservingloopupdate only increases (+1)
+   or only decreases (-1) the register, from the range of the step; 0 if unknown. */
+static int _loopupdatedirection(optimizer *opt, block *blk, registerindx r) {
+    reginfo *info = &blk->rout.rinfo[r];
+    instruction write = optimize_getinstructionat(opt, info->iindx);
+    registerindx other = (DECODE_B(write)==r ? DECODE_C(write) : DECODE_B(write));
+    int lo, hi;
+
+    if (optimize_isclobberedbetween(opt, info->iindx+1, blk->end+1, other) ||
+        !_intfactrange(blk, &blk->rout.rinfo[other], &lo, &hi)) return 0;
+
+    if (DECODE_OP(write)==OP_SUB) {
+        int t = lo;
+        if (hi==REGRANGE_MAX) lo = REGRANGE_MIN;
+        else if (__builtin_sub_overflow(0, hi, &lo)) return 0; // A step of INT_MIN has no negation
+        hi = (t==REGRANGE_MIN ? REGRANGE_MAX : -t);
+    }
+
+    if (lo>=0) return 1;
+    if (hi<=0) return -1;
+    return 0;
+}
+
+static void _resolveloopheader(optimizer *opt, block *blk, int nsrc, block **src, reginfolist *facts, reginfolist *dest) {
+    block *entrypred[nsrc], *backpred[nsrc];
+    reginfolist entryfacts[nsrc], backfacts[nsrc];
     int nentry=0, nback=0;
 
     for (int i=0; i<nsrc; i++) {
@@ -2131,18 +3658,20 @@ static void _resolveloopheader(optimizer *opt, block *blk, int nsrc, block **src
 
         if (!cfgraph_findindx(&opt->graph, src[i], &srcindx)) continue;
         if (_isloopbackedgepred(blk, srcindx)) {
+            backfacts[nback]=facts[i];
             backpred[nback++]=src[i];
         } else {
+            entryfacts[nentry]=facts[i];
             entrypred[nentry++]=src[i];
         }
     }
 
     if (nentry==0 || nback==0) {
-        _resolve(nsrc, src, dest);
+        _resolve(nsrc, src, facts, dest);
         return;
     }
 
-    _resolve(nentry, entrypred, dest);
+    _resolve(nentry, entrypred, entryfacts, dest);
 
     for (int i=0; i<dest->nreg; i++) {
         reginfo baseline, joined;
@@ -2166,26 +3695,55 @@ static void _resolveloopheader(optimizer *opt, block *blk, int nsrc, block **src
         }
 
         if (preserve) {
+            /* Widen the entry range in the direction the update moves the induction variable; this
+               is only sound if that update is the only write to it anywhere in the loop */
+            int direction = 0, lo, hi;
+            instructionindx update;
+            if (_loopsinglewrite(opt, blk, i, &update)) {
+                for (int k=0; k<nback; k++) {
+                    int d = (backpred[k]->rout.rinfo[i].iindx==update ? _loopupdatedirection(opt, backpred[k], i) : 0);
+                    direction = (k==0 || d==direction ? d : 0);
+                }
+            }
+            bool ranged = _intfactrange(blk, &baseline, &lo, &hi);
+
             _preserveexactintfact(&baseline);
+            baseline.lo = (ranged && direction>0 ? lo : REGRANGE_MIN);
+            baseline.hi = (ranged && direction<0 ? hi : REGRANGE_MAX);
             dest->rinfo[i]=baseline;
             continue;
         }
 
         joined=baseline;
         for (int k=0; k<nback; k++) {
-            reginfo_join(&joined, &backpred[k]->rout.rinfo[i]);
+            reginfo_join(&joined, &backfacts[k].rinfo[i]);
         }
         joined.hasalias=false;
         joined.alias=0;
+
+        // Widen any bound that grew since the previous visit so that ranges converge
+        reginfo *old = &blk->rin.rinfo[i];
+        if (i<blk->rin.nreg && old->contents!=REG_NOFACT) {
+            if (joined.lo<old->lo) joined.lo=REGRANGE_MIN;
+            if (joined.hi>old->hi) joined.hi=REGRANGE_MAX;
+        }
         dest->rinfo[i]=joined;
     }
 }
 
+/** Checks if a function's entry block is also reached by a branch, as once tail recursion has become a loop */
+static bool _optimize_isreentered(optimizer *opt, objectfunction *func) {
+    block *entry;
+    return (cfgraph_findblock(&opt->graph, func->entry, &entry) && entry->src.count>0);
+}
+
 static void optimize_applyfunctioninput(optimizer *opt, block *blk) {
     value ix;
     bool recursive;
     functioninputinfo *info;
 
+    // Parameters of a re-entered function also hold the values moved in before the branch
+    if (_optimize_isreentered(opt, blk->func)) return;
     if (!dictionary_get(&opt->functioninputindx, MORPHO_OBJECT(blk->func), &ix) || !MORPHO_ISINTEGER(ix)) return;
 
     info = &opt->functioninputs.data[MORPHO_GETINTEGERVALUE(ix)];
@@ -2204,38 +3762,95 @@ static void optimize_applyfunctioninput(optimizer *opt, block *blk) {
     }
 }
 
+/** Checks if the edge from pred to blk is a pusherr branch table entry, along which no error has yet been raised */
+static bool _ishandleredge(optimizer *opt, block *pred, block *blk) {
+    return (DECODE_OP(optimize_getinstructionat(opt, pred->end))==OP_PUSHERR &&
+            blk->start!=pred->end+1);
+}
+
+/** Finds the blocks within a handler's try region that may raise an error to it; out may be NULL to count them */
+static int _findraisingblocks(optimizer *opt, block *handler, block **out) {
+    int n=0;
+    for (int i=0; i<handler->region.capacity; i++) {
+        value key = handler->region.contents[i].key;
+        block *b;
+        if (!MORPHO_ISINTEGER(key) ||
+            !cfgraph_indx(&opt->graph, MORPHO_GETINTEGERVALUE(key), &b)) continue;
+        if (b->raises && optimize_blockisreachable(opt, b)) {
+            if (out) out[n]=b;
+            n++;
+        }
+    }
+    return n;
+}
+
 static void optimize_joinblockinput(optimizer *opt, block *blk) {
     reginfolist_wipe(&opt->rlist, blk->func->nregs);
     
     optimize_signature(opt); // Restore function parameters
     optimize_applyfunctioninput(opt, blk);
     
-    int nentry = blk->src.count;
+    // A handler is entered from the states at the points that raise, not from pusherr
+    int nraise = _findraisingblocks(opt, blk, NULL);
+    int nentry = blk->src.count + nraise;
     if (!block_isentry(blk) &&
         nentry>0) {
         block *srcblk[nentry]; // Unpack and find source blocks from the dictionary
+        int k=0;
         
-        for (int i=0, k=0; i<blk->src.capacity; i++) {
+        for (int i=0; i<blk->src.capacity; i++) {
             value key = blk->src.contents[i].key;
             blockindx srcindx;
             if (MORPHO_ISNIL(key)) continue;
             
             srcindx = MORPHO_GETINTEGERVALUE(key);
             if (!cfgraph_indx(&opt->graph, srcindx, &srcblk[k])) return;
-            k++;
+            if (!_ishandleredge(opt, srcblk[k], blk)) k++;
         }
+
+        int nedge = k;
+        nentry = k + _findraisingblocks(opt, blk, srcblk+k);
+        if (!nentry) return;
         
+        reginfolist facts[nentry]; // Facts along each incoming edge
+        for (int k=0; k<nentry; k++) {
+            if (k<nedge) {
+                reginfolist_init(&facts[k], srcblk[k]->rout.nreg);
+                _edgefacts(opt, srcblk[k], blk, &facts[k]);
+            } else {
+                reginfolist_init(&facts[k], srcblk[k]->rexc.nreg);
+                reginfolist_copy(&srcblk[k]->rexc, &facts[k]);
+            }
+        }
+
         if (block_isloopheader(blk)) {
-            _resolveloopheader(opt, blk, blk->src.count, srcblk, &opt->rlist);
+            _resolveloopheader(opt, blk, nentry, srcblk, facts, &opt->rlist);
         } else {
-            _resolve(blk->src.count, srcblk, &opt->rlist);
+            _resolve(nentry, srcblk, facts, &opt->rlist);
         }
+
+        for (int k=0; k<nentry; k++) reginfolist_clear(&facts[k]);
     }
 }
 
 static void optimize_loadblockinput(optimizer *opt, block *blk) {
     reginfolist_wipe(&opt->rlist, blk->func->nregs);
     reginfolist_copy(&blk->rin, &opt->rlist);
+    opt->availableloads.count=0;
+}
+
+/** Joins the current facts into the state seen by a block's handlers */
+static void _optimize_recordraise(optimizer *opt, block *blk) {
+    if (!blk->raises) {
+        reginfolist_wipe(&blk->rexc, opt->rlist.nreg);
+        reginfolist_copy(&opt->rlist, &blk->rexc);
+        blk->raises=true;
+        return;
+    }
+
+    for (int i=0; i<blk->rexc.nreg && i<opt->rlist.nreg; i++) {
+        reginfo_join(&blk->rexc.rinfo[i], &opt->rlist.rinfo[i]);
+    }
 }
 
 /** Simulates a block without applying rewrites to compute output facts from input facts. */
@@ -2243,10 +3858,13 @@ static void optimize_transferblock(optimizer *opt, block *blk) {
     opt->currentblk=blk;
     optimize_joinblockinput(opt, blk);
     reginfolist_copy(&opt->rlist, &blk->rin);
+    opt->availableloads.count=0;
 
+    blk->raises=false;
     for (instructionindx i=blk->start; i<=blk->end && !optimize_checkerror(opt); i++) {
         optimize_fetch(opt, i);
         optimize_usage(opt);
+        if (_optimize_raisestohandler(opt)) _optimize_recordraise(opt, blk);
         optimize_track(opt);
     }
 
@@ -2284,6 +3902,18 @@ static void optimize_queuesuccessors(optimizer *opt, block *blk, varray_instruct
         }
     }
 
+    // Errors raised within the block enter its handlers
+    for (int i=0; i<blk->handlers.capacity; i++) {
+        value key = blk->handlers.contents[i].key;
+        block *handler;
+
+        if (MORPHO_ISINTEGER(key) &&
+            cfgraph_indx(&opt->graph, MORPHO_GETINTEGERVALUE(key), &handler) &&
+            optimize_blockisreachable(opt, handler)) {
+            varray_instructionindxwrite(worklist, MORPHO_GETINTEGERVALUE(key));
+        }
+    }
+
     if (printed) printf("\n");
 }
 
@@ -2313,7 +3943,7 @@ static void optimize_dataflow(optimizer *opt) {
         instructionindx indx;
         varray_instructionindxpop(&worklist, &indx);
         block *blk;
-        reginfolist oldrin, oldrout;
+        reginfolist oldrin, oldrout, oldrexc;
         bool firstvisit;
         bool rinchanged, routchanged;
 
@@ -2327,12 +3957,20 @@ static void optimize_dataflow(optimizer *opt) {
         reginfolist_init(&oldrout, blk->func->nregs);
         reginfolist_copy(&blk->rin, &oldrin);
         reginfolist_copy(&blk->rout, &oldrout);
+        reginfolist_init(&oldrexc, blk->rexc.nreg);
+        reginfolist_copy(&blk->rexc, &oldrexc);
 
         opt->ipachanged=false;
         optimize_transferblock(opt, blk);
         if (opt->ipachanged) optimize_queueentryblocks(opt, &worklist);
+        while (opt->summaryqueue.count>0) {
+            instructionindx dependent;
+            varray_instructionindxpop(&opt->summaryqueue, &dependent);
+            varray_instructionindxwrite(&worklist, dependent);
+        }
         rinchanged = !reginfolist_equal(&oldrin, &blk->rin);
-        routchanged = !reginfolist_equal(&oldrout, &blk->rout);
+        routchanged = (!reginfolist_equal(&oldrout, &blk->rout) ||
+                       !reginfolist_equal(&oldrexc, &blk->rexc));
 
         if (opt->verbose) {
             printf("Visit block [%ti, %ti] rin=%s rout=%s\n", blk->start, blk->end,
@@ -2352,6 +3990,7 @@ static void optimize_dataflow(optimizer *opt) {
 
         reginfolist_clear(&oldrin);
         reginfolist_clear(&oldrout);
+        reginfolist_clear(&oldrexc);
 
         if (firstvisit || routchanged) optimize_queuesuccessors(opt, blk, &worklist);
     }
@@ -2389,6 +4028,7 @@ static bool optimize_applyrequirednregs(optimizer *opt) {
             block *blk = &opt->graph.data[i];
             if (blk->rin.nreg<blk->func->nregs) reginfolist_resize(&blk->rin, blk->func->nregs);
             if (blk->rout.nreg<blk->func->nregs) reginfolist_resize(&blk->rout, blk->func->nregs);
+            if (blk->rexc.nreg<blk->func->nregs) reginfolist_resize(&blk->rexc, blk->func->nregs);
         }
     }
 
@@ -2434,6 +4074,25 @@ static registerindx _optimize_requiredinstructionregs(instruction instr) {
     }
 }
 
+/** Remaps a closeup to the first surviving register at or above its threshold, as it closes every upvalue from there */
+static instruction _optimize_remapcloseup(instruction instr, registerindx *map, registerindx nreg, registerindx newnreg) {
+    for (registerindx r=DECODE_A(instr); r<nreg; r++) {
+        if (map[r]!=REGISTER_UNALLOCATED) return ENCODE(OP_CLOSEUP, map[r], DECODE_B(instr), DECODE_C(instr));
+    }
+    return ENCODE(OP_CLOSEUP, newnreg, DECODE_B(instr), DECODE_C(instr));
+}
+
+/** Remaps the captured registers in the closure prototypes of a function */
+static void _optimize_remapprototypes(objectfunction *func, registerindx *map) {
+    for (unsigned int p=0; p<func->prototype.count; p++) {
+        varray_upvalue *prototype = &func->prototype.data[p];
+        for (unsigned int i=0; i<prototype->count; i++) {
+            upvalue *up = &prototype->data[i];
+            if (up->islocal && map[up->reg]!=REGISTER_UNALLOCATED) up->reg = map[up->reg];
+        }
+    }
+}
+
 static instruction _optimize_remapinstruction(instruction instr, registerindx *map) {
     instruction op = DECODE_OP(instr);
     opcodeflags flags = opcode_getflags(op);
@@ -2451,6 +4110,7 @@ static instruction _optimize_remapinstruction(instruction instr, registerindx *m
         case OP_PUSHERR:
         case OP_POPERR:
             return ENCODE_LONG(op, DECODE_A(instr), DECODE_sBx(instr));
+
         case OP_BIF:
         case OP_BIFF:
             return ENCODE_LONG(op, map[a], DECODE_sBx(instr));
@@ -2515,7 +4175,6 @@ static void optimize_compactframes(optimizer *opt) {
                 registerindx required = _optimize_requiredinstructionregs(instr);
                 opcodeflags flags = opcode_getflags(DECODE_OP(instr));
 
-                if (DECODE_OP(instr)==OP_CLOSURE) canremap=false;
                 opcode_usageforinstruction(fblk, instr, _optimize_markusedregister, used);
                 if (opcode_overwritesforinstruction(instr, &overwrites)) used[overwrites] = true;
                 if (required>requirednreg) requirednreg=required;
@@ -2560,9 +4219,13 @@ static void optimize_compactframes(optimizer *opt) {
                 if (fblk->func!=func || !optimize_blockisreachable(opt, fblk)) continue;
 
                 for (instructionindx pc=fblk->start; pc<=fblk->end; pc++) {
-                    optimize_replaceinstructionat(opt, pc, _optimize_remapinstruction(optimize_getinstructionat(opt, pc), map));
+                    instruction instr = optimize_getinstructionat(opt, pc);
+                    optimize_replaceinstructionat(opt, pc, (DECODE_OP(instr)==OP_CLOSEUP ?
+                                                            _optimize_remapcloseup(instr, map, oldnreg, newnreg) :
+                                                            _optimize_remapinstruction(instr, map)));
                 }
             }
+            _optimize_remapprototypes(func, map);
         } else if (!canremap) {
             newnreg = maxreg + 1;
             if (requirednreg>newnreg) newnreg=requirednreg;
@@ -2574,6 +4237,134 @@ static void optimize_compactframes(optimizer *opt) {
     dictionary_clear(&seen);
 }
 
+/* -------------------------------------
+ * Constant table compaction
+ * ------------------------------------- */
+
+/** Checks whether an instruction indexes the constant table of its function */
+static bool _optimize_indexesconstant(instruction instr) {
+    instruction op = DECODE_OP(instr);
+    return (op==OP_LCT || op==OP_PUSHERR || op==OP_TYPECHECK);
+}
+
+/** Drops the constants of a function that no instruction refers to and renumbers the rest */
+static void _optimize_compactconstanttable(optimizer *opt, objectfunction *func) {
+    unsigned int nk = func->konst.count, n=0;
+    bool used[nk > 0 ? nk : 1];
+    indx map[nk > 0 ? nk : 1];
+
+    // Defaults of optional parameters are read by index when the function is called
+    if (func->nopt>0) return;
+
+    for (unsigned int k=0; k<nk; k++) used[k]=false;
+
+    for (int i=0; i<opt->graph.count; i++) {
+        block *blk = &opt->graph.data[i];
+        if (blk->func!=func) continue;
+
+        for (instructionindx pc=blk->start; pc<=blk->end; pc++) {
+            instruction instr = optimize_getinstructionat(opt, pc);
+            if (!_optimize_indexesconstant(instr)) continue;
+            if (DECODE_Bx(instr)>=nk) return; // Leave a table we cannot account for untouched
+            used[DECODE_Bx(instr)]=true;
+        }
+    }
+
+    for (unsigned int k=0; k<nk; k++) {
+        if (used[k]) func->konst.data[n]=func->konst.data[k];
+        map[k]=(used[k] ? (indx) n++ : 0);
+    }
+    if (n==nk) return;
+    func->konst.count=n;
+
+    for (int i=0; i<opt->graph.count; i++) {
+        block *blk = &opt->graph.data[i];
+        if (blk->func!=func) continue;
+
+        for (instructionindx pc=blk->start; pc<=blk->end; pc++) {
+            instruction instr = optimize_getinstructionat(opt, pc);
+            if (!_optimize_indexesconstant(instr)) continue;
+            optimize_replaceinstructionat(opt, pc, ENCODE_LONG(DECODE_OP(instr), DECODE_A(instr), map[DECODE_Bx(instr)]));
+        }
+    }
+}
+
+/** Marks an object constant and any objects held inside it as referenced */
+static void _optimize_markconstant(dictionary *marked, value val) {
+    if (!MORPHO_ISOBJECT(val) || dictionary_get(marked, val, NULL)) return;
+    dictionary_insert(marked, val, MORPHO_NIL);
+
+    if (MORPHO_ISTUPLE(val)) {
+        objecttuple *tuple = MORPHO_GETTUPLE(val);
+        for (unsigned int i=0; i<tuple->length; i++) _optimize_markconstant(marked, tuple->tuple[i]);
+    } else if (MORPHO_ISLIST(val)) {
+        objectlist *list = MORPHO_GETLIST(val);
+        for (unsigned int i=0; i<list->val.count; i++) _optimize_markconstant(marked, list->val.data[i]);
+    } else if (MORPHO_ISDICTIONARY(val)) {
+        dictionary *dict = &MORPHO_GETDICTIONARY(val)->dict;
+        for (unsigned int i=0; i<dict->capacity; i++) {
+            if (MORPHO_ISNIL(dict->contents[i].key)) continue;
+            _optimize_markconstant(marked, dict->contents[i].key);
+            _optimize_markconstant(marked, dict->contents[i].val);
+        }
+    }
+}
+
+/** Unlinks an object from the objects bound to a program and frees it */
+static void _optimize_unbindobject(program *p, object *obj) {
+    for (object **link=&p->boundlist; *link; link=&(*link)->next) {
+        if (*link!=obj) continue;
+        *link=obj->next;
+        obj->next=NULL;
+        morpho_freeobject(MORPHO_OBJECT(obj));
+        return;
+    }
+}
+
+/** Compacts the constant table of every function in the graph and shares immutable constants
+    between them, then frees constants that the optimizer created and no table refers to any more */
+static void optimize_compactconstants(optimizer *opt) {
+    dictionary seen, marked;
+
+    dictionary_init(&seen);
+    for (int i=0; i<opt->graph.count; i++) {
+        objectfunction *func = opt->graph.data[i].func;
+        if (!func || dictionary_get(&seen, MORPHO_OBJECT(func), NULL)) continue;
+        dictionary_insert(&seen, MORPHO_OBJECT(func), MORPHO_NIL);
+        _optimize_compactconstanttable(opt, func);
+    }
+    dictionary_clear(&seen);
+
+    // Share one instance of each immutable constant across the functions of the graph
+    for (int i=0; i<opt->graph.count; i++) {
+        objectfunction *func = opt->graph.data[i].func;
+        if (!func) continue;
+        for (unsigned int k=0; k<func->konst.count; k++) {
+            func->konst.data[k]=_optimize_internconstant(opt, func->konst.data[k]);
+        }
+    }
+
+    dictionary_init(&marked);
+    for (object *obj=opt->prog->boundlist; obj; obj=obj->next) {
+        if (obj->type!=OBJECT_FUNCTION) continue;
+        objectfunction *func = (objectfunction *) obj;
+        for (unsigned int k=0; k<func->konst.count; k++) _optimize_markconstant(&marked, func->konst.data[k]);
+    }
+    if (opt->prog->global) {
+        for (unsigned int k=0; k<opt->prog->global->konst.count; k++) _optimize_markconstant(&marked, opt->prog->global->konst.data[k]);
+    }
+
+    // Functions, classes and metafunctions may be referenced from annotations and class tables
+    for (unsigned int i=0; i<opt->boundconstants.count; i++) {
+        value val = opt->boundconstants.data[i];
+        if (MORPHO_ISFUNCTION(val) || MORPHO_ISCLASS(val) || MORPHO_ISMETAFUNCTION(val) ||
+            MORPHO_ISCLOSURE(val) || dictionary_get(&marked, val, NULL)) continue;
+        _optimize_unbindobject(opt->prog, MORPHO_GETOBJECT(val));
+    }
+    opt->boundconstants.count=0;
+    dictionary_clear(&marked);
+}
+
 /** Run an optimization pass */
 void optimize_pass(optimizer *opt, int n) {
     opt->pass=n;
@@ -2628,6 +4419,7 @@ bool optimize(program *in) {
     // Layout final code and repair associated data structures
     if (success) {
         optimize_compactframes(&opt);
+        optimize_compactconstants(&opt);
         layout(&opt);
     }
     
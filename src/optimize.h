@@ -14,6 +14,9 @@
 
 //#define OPTIMIZER_VERBOSE
 
+/** Total number of instructions the optimizer may add by cloning functions */
+#define OPTIMIZER_CLONE_BUDGET 256
+
 /* **********************************************************************
  * Optimizer data structure
  * ********************************************************************** */
@@ -25,6 +28,59 @@ typedef struct {
 
 DECLARE_VARRAY(functioninputinfo, functioninputinfo)
 
+/** Effect classes for functions, ordered so that joining takes the maximum */
+typedef enum {
+    FUNCTIONEFFECT_PURE,        /** Result depends only on the arguments; no observable effects */
+    FUNCTIONEFFECT_READONLY,    /** Reads globals or upvalues but writes nothing */
+    FUNCTIONEFFECT_EFFECTFUL    /** Writes state, produces output, may raise or calls unknown code */
+} functioneffect;
+
+typedef struct {
+    objectfunction *func;
+    reginfo ret; /** Join of the facts of every returned operand */
+    functioneffect effect; /** Join of the effects of every instruction in the function */
+    dictionary modglobals; /** Globals the function may write, transitively */
+    bool modallglobals; /** Whether the function may write any global */
+    bool modupvalues; /** Whether the function may write upvalues */
+    dictionary dependents; /** Blocks that applied this summary at a call site */
+} functionsummary;
+
+DECLARE_VARRAY(functionsummary, functionsummary)
+
+/** A container load or store whose value is still held in a register */
+typedef struct {
+    registerindx obj; /** Register holding the object */
+    value label; /** Property label, or nil for an index access */
+    registerindx index; /** Register holding the index of an index access */
+    registerindx dest; /** Register holding the value */
+} availableload;
+
+DECLARE_VARRAY(availableload, availableload)
+
+/** A memoized reduction of a metafunction for the types of its arguments */
+typedef struct {
+    value fn; /** The metafunction */
+    int nargs; /** Number of arguments */
+    int types; /** Offset of the argument types in reductiontypes */
+    bool success; /** Whether the metafunction could be reduced */
+    value result; /** The implementation selected */
+    int next; /** Next query on the same metafunction, or -1 */
+} reductionquery;
+
+DECLARE_VARRAY(reductionquery, reductionquery)
+
+/** A memoized method lookup on a class */
+typedef struct {
+    value klass; /** The class */
+    value label; /** The method label */
+    bool found; /** Whether the class provides the method */
+    value method; /** The implementation found */
+    bool unique; /** Whether every subclass inherits the same implementation */
+    int next; /** Next query on the same class, or -1 */
+} methodquery;
+
+DECLARE_VARRAY(methodquery, methodquery)
+
 typedef struct {
     program *prog;
     
@@ -37,11 +93,25 @@ typedef struct {
     reginfolist rlist; /** Used to track register state */
     globalinfolist glist; /** Used to track globals */
     classinfolist classinfo; /** Store class construction metadata */
+    classhierarchy classes; /** Index of subclass relationships */
     functioninfolist functioninfo; /** Store per-function metadata */
     varray_functioninputinfo functioninputs; /** Inferred call-site inputs for functions */
     dictionary functioninputindx; /** Map functions to functioninputs indices */
+    varray_functionsummary summaries; /** Return summaries for functions */
+    dictionary summaryindx; /** Map functions to summaries indices */
+    varray_instructionindx summaryqueue; /** Dependent blocks to revisit after a summary changes */
     dictionary requirednregs; /** Requested register counts for subsequent passes */
     dictionary processedlabels; /** Labels whose method escapes were already processed this pass */
+    dictionary inboundsaccesses; /** lix/lixl instructions whose index is proven to be in range */
+    dictionary validcalls; /** Calls to builtins whose arguments are proven to match the signature */
+    varray_availableload availableloads; /** Loads in the current block that remain valid */
+    varray_value boundconstants; /** Constant objects that the optimizer bound to the program */
+    dictionary internedconstants; /** Program-wide instances of immutable constant objects */
+    varray_reductionquery reductions; /** Metafunction reductions computed so far */
+    varray_value reductiontypes; /** Argument types of the memoized reductions */
+    dictionary reductionindx; /** Map metafunctions to their first reduction */
+    varray_methodquery methodqueries; /** Method lookups computed so far */
+    dictionary methodqueryindx; /** Map classes to their first method lookup */
     
     int pass; /** Count passes */
     
@@ -57,6 +127,9 @@ typedef struct {
     
     bool verbose; /** Provide debugging output */
     bool ipachanged; /** Whether interprocedural facts changed during dataflow */
+    
+    dictionary clonedfunctions; /** Functions that have been cloned */
+    int nclonedinstructions; /** Instructions added by cloning, bounded by OPTIMIZER_CLONE_BUDGET */
 } optimizer;
 
 /** Function that can be called by the optimizer to set the contents of the register info file */
@@ -87,8 +160,23 @@ value optimize_type(optimizer *opt, registerindx r);
 regtypeinfo optimize_typeinfo(optimizer *opt, registerindx r);
 bool optimize_typefromvalue(value val, value *type);
 bool optimize_classisleaf(objectclass *klass);
-bool optimize_classisderivedfrom(objectclass *klass, objectclass *base);
+bool optimize_classisderivedfrom(optimizer *opt, objectclass *klass, objectclass *base);
 bool optimize_recordcallsite(optimizer *opt, objectfunction *func, registerindx argstart, int nargs, registerindx selfreg);
+void optimize_recordreturn(optimizer *opt, registerindx r);
+void optimize_applyreturnsummary(optimizer *opt, registerindx r, objectfunction *func);
+void optimize_raiseeffect(optimizer *opt, functioneffect effect);
+functioneffect optimize_calleffect(optimizer *opt, value callable);
+void optimize_recordglobalwrite(optimizer *opt, indx gindx);
+void optimize_recordupvaluewrite(optimizer *opt);
+void optimize_invalidatenonlocals(optimizer *opt, value callable);
+bool optimize_findwriter(optimizer *opt, block *blk, registerindx r, instructionindx before, instructionindx *out);
+bool optimize_calltarget(optimizer *opt, block *blk, instructionindx iindx, value *out);
+bool optimize_findavailableproperty(optimizer *opt, registerindx obj, registerindx label, registerindx *out);
+bool optimize_findavailableindex(optimizer *opt, registerindx obj, registerindx index, registerindx *out);
+bool optimize_reducemetafunction(optimizer *opt, value fn, int nargs, value *types, value *out);
+bool optimize_lookupmethod(optimizer *opt, value klass, value label, value *method, bool *unique);
+bool optimize_callsiteismoreprecise(optimizer *opt, objectfunction *func, registerindx argstart, int nargs);
+bool optimize_clonefunction(optimizer *opt, objectfunction *func, objectfunction **out);
 void optimize_markrecursive(optimizer *opt, objectfunction *func);
 
 value optimize_getconstant(optimizer *opt, indx i);
@@ -100,13 +188,29 @@ bool optimize_isglobal(optimizer *opt, registerindx i, indx *indx);
 bool optimize_isregister(optimizer *opt, registerindx i, registerindx *indx);
 bool optimize_contents(optimizer *opt, registerindx i, regcontents *contents, indx *indx);
 bool optimize_hasuniquetype(optimizer *opt, registerindx r);
+void optimize_setlength(optimizer *opt, registerindx r, int length);
+int optimize_length(optimizer *opt, registerindx r);
+void optimize_invalidatelengths(optimizer *opt);
+void optimize_setrange(optimizer *opt, registerindx r, int lo, int hi);
+bool optimize_intrange(optimizer *opt, registerindx r, int *lo, int *hi);
+bool optimize_isinbounds(optimizer *opt, registerindx obj, registerindx ix);
+void optimize_markaccess(optimizer *opt, bool inbounds);
+bool optimize_builtinargsarevalid(optimizer *opt, value callable, registerindx argstart, int nargs, int nopt);
+void optimize_markcall(optimizer *opt, bool valid);
 bool optimize_hasexacttype(optimizer *opt, registerindx r);
+bool optimize_satisfiestype(optimizer *opt, registerindx r, value klass);
 void optimize_markescaped(optimizer *opt, objectfunction *func);
 void optimize_markinitconstructoruse(optimizer *opt, objectfunction *func);
 void optimize_markinitmethoduse(optimizer *opt, objectfunction *func);
 void optimize_markmethodsforlabelescaped(optimizer *opt, value label);
 
 bool optimize_isoverwritten(optimizer *opt, registerindx i, instructionindx start);
+bool optimize_isinvariantconstant(optimizer *opt, objectfunction *func, registerindx r, indx kindx);
+bool optimize_writesupvalue(optimizer *opt, objectfunction *func, indx uindx);
+int optimize_bindupvalue(optimizer *opt, objectfunction *func, indx uindx, value val);
+bool optimize_capturesfrom(optimizer *opt, objectfunction *func, registerindx r);
+bool optimize_capturedbyother(optimizer *opt, objectfunction *func, unsigned int p, registerindx r);
+bool optimize_isclobberedbetween(optimizer *opt, instructionindx start, instructionindx end, registerindx r);
 
 registerindx optimize_findoriginalregister(optimizer *opt, registerindx rindx);
 bool optimize_findconstant(optimizer *opt, registerindx i, indx *out);
@@ -124,6 +228,11 @@ void optimize_replaceinstructionat(optimizer *opt, instructionindx i, instructio
 bool optimize_replacewithloadconstant(optimizer *opt, registerindx r, value konst);
 void optimize_insertinstructions(optimizer *opt, int n, instruction *instr);
 void optimize_insertinstructionswithrestart(optimizer *opt, int n, instruction *instr, bool restart);
+void optimize_insertinstructionsafter(optimizer *opt, instructionindx iindx, int n, instruction *instr);
+bool optimize_canexpandat(optimizer *opt, block *blk, instructionindx iindx);
+bool optimize_insertinstructionsat(optimizer *opt, block *blk, instructionindx iindx, int n, instruction *instr);
+bool optimize_canprependinstructions(optimizer *opt, block *blk);
+bool optimize_prependinstructions(optimizer *opt, block *blk, int n, instruction *instr);
 
 bool optimize_deleteinstruction(optimizer *opt, instructionindx indx);
 
@@ -9,6 +9,10 @@
 #include "morphocore.h"
 #include "reginfo.h"
 #include "cfgraph.h"
+#include "info.h"
+
+/** Class hierarchy of the program being optimized, if any */
+static classhierarchy *reginfo_hierarchy=NULL;
 
 static bool reginfo_hasindexedcontents(regcontents contents);
 static void reginfo_clearsource(reginfo *info);
@@ -30,6 +34,9 @@ void reginfo_init(reginfo *info) {
     info->iindx=INSTRUCTIONINDX_EMPTY;
     info->type=MORPHO_NIL;
     info->typeinfo=REGTYPE_UNKNOWN;
+    info->length=REGLENGTH_UNKNOWN;
+    info->lo=REGRANGE_MIN;
+    info->hi=REGRANGE_MAX;
     info->hasalias=false;
     info->alias=0;
 }
@@ -84,6 +91,8 @@ bool reginfo_equal(reginfo *a, reginfo *b) {
     return (a->contents==b->contents &&
             a->usage==b->usage &&
             a->typeinfo==b->typeinfo &&
+            a->length==b->length &&
+            a->lo==b->lo && a->hi==b->hi &&
             a->iindx==b->iindx &&
             a->hasalias==b->hasalias &&
             (!a->hasalias || a->alias==b->alias) &&
@@ -133,51 +142,21 @@ static void reginfo_normalize(reginfo *info) {
     if (info->contents==REG_NOFACT) {
         reginfo_clearalias(info);
         info->usage=REGUSE_NONE;
+        info->length=REGLENGTH_UNKNOWN;
+        info->lo=REGRANGE_MIN;
+        info->hi=REGRANGE_MAX;
     }
 }
 
-static bool reginfo_findinlinearization(objectclass *klass, objectclass *target, int *out) {
-    if (!klass || !target || !out) return false;
-
-    for (int i=0; i<klass->linearization.count; i++) {
-        if (MORPHO_ISCLASS(klass->linearization.data[i]) &&
-            MORPHO_GETCLASS(klass->linearization.data[i])==target) {
-            *out=i;
-            return true;
-        }
-    }
-
-    return false;
+/** Sets the class hierarchy index to consult when joining types, or NULL to query classes directly */
+void reginfo_setclasshierarchy(classhierarchy *hierarchy) {
+    reginfo_hierarchy=hierarchy;
 }
 
 static bool reginfo_commonancestor(value a, value b, value *out) {
     if (!MORPHO_ISCLASS(a) || !MORPHO_ISCLASS(b) || !out) return false;
 
-    objectclass *aclass = MORPHO_GETCLASS(a);
-    objectclass *bclass = MORPHO_GETCLASS(b);
-    objectclass *best = NULL;
-    int bestscore = INT_MAX;
-    int bestdepth = INT_MAX;
-
-    for (int i=0; i<aclass->linearization.count; i++) {
-        value candidate = aclass->linearization.data[i];
-        int j;
-
-        if (!MORPHO_ISCLASS(candidate)) continue;
-        if (!reginfo_findinlinearization(bclass, MORPHO_GETCLASS(candidate), &j)) continue;
-
-        int score = ((i>j) ? i : j);
-        int depth = i+j;
-        if (!best || score<bestscore || (score==bestscore && depth<bestdepth)) {
-            best = MORPHO_GETCLASS(candidate);
-            bestscore = score;
-            bestdepth = depth;
-        }
-    }
-
-    if (!best) return false;
-    *out = MORPHO_OBJECT(best);
-    return true;
+    return classhierarchy_commonancestor(reginfo_hierarchy, MORPHO_GETCLASS(a), MORPHO_GETCLASS(b), out);
 }
 
 /** Joins type information while allowing subtype-compatible facts to survive. */
@@ -258,6 +237,9 @@ void reginfo_join(reginfo *dest, reginfo *src) {
     }
 
     reginfo_jointype(&joined, &incoming);
+    if (joined.length!=incoming.length) joined.length=REGLENGTH_UNKNOWN;
+    if (incoming.lo<joined.lo) joined.lo=incoming.lo;
+    if (incoming.hi>joined.hi) joined.hi=incoming.hi;
 
     if (!(joined.hasalias && incoming.hasalias && joined.alias==incoming.alias)) {
         reginfo_clearalias(&joined);
@@ -309,6 +291,9 @@ void reginfolist_write(reginfolist *rlist, instructionindx iindx, int rindx, reg
     rlist->rinfo[rindx].iindx=iindx;
     rlist->rinfo[rindx].type=MORPHO_NIL;
     rlist->rinfo[rindx].typeinfo=REGTYPE_UNKNOWN;
+    rlist->rinfo[rindx].length=REGLENGTH_UNKNOWN;
+    rlist->rinfo[rindx].lo=REGRANGE_MIN;
+    rlist->rinfo[rindx].hi=REGRANGE_MAX;
     reginfo_clearalias(&rlist->rinfo[rindx]);
 
     reginfolist_incwrite(rlist, rindx);
@@ -342,12 +327,48 @@ void reginfolist_settypeinfo(reginfolist *rlist, int rindx, value type, regtypei
     }
 }
 
+/** Sets the known element count of a list or tuple held in a register */
+void reginfolist_setlength(reginfolist *rlist, int rindx, int length) {
+    if (rindx>=rlist->nreg) return;
+    rlist->rinfo[rindx].length=length;
+}
+
+/** Forgets the lengths of every register that is not known to hold the given immutable type */
+void reginfolist_invalidatelengths(reginfolist *rlist, value immutabletype) {
+    for (registerindx i=0; i<rlist->nreg; i++) {
+        if (rlist->rinfo[i].typeinfo==REGTYPE_EXACT &&
+            MORPHO_ISEQUAL(rlist->rinfo[i].type, immutabletype)) continue;
+        rlist->rinfo[i].length=REGLENGTH_UNKNOWN;
+    }
+}
+
+/** Sets inclusive bounds on the Int value held in a register */
+void reginfolist_setrange(reginfolist *rlist, int rindx, int lo, int hi) {
+    if (rindx>=rlist->nreg) return;
+    rlist->rinfo[rindx].lo=lo;
+    rlist->rinfo[rindx].hi=hi;
+}
+
+/** Gets bounds on the value held in a register; returns true if either bound is known */
+bool reginfolist_range(reginfolist *rlist, int rindx, int *lo, int *hi) {
+    if (rindx>=rlist->nreg) return false;
+    if (lo) *lo=rlist->rinfo[rindx].lo;
+    if (hi) *hi=rlist->rinfo[rindx].hi;
+    return (rlist->rinfo[rindx].lo!=REGRANGE_MIN || rlist->rinfo[rindx].hi!=REGRANGE_MAX);
+}
+
 /** Gets the type associated with a register */
 value reginfolist_type(reginfolist *rlist, int rindx) {
     if (rindx>=rlist->nreg) return MORPHO_NIL;
     return rlist->rinfo[rindx].type;
 }
 
+/** Gets the known element count of a list or tuple held in a register */
+int reginfolist_length(reginfolist *rlist, int rindx) {
+    if (rindx>=rlist->nreg) return REGLENGTH_UNKNOWN;
+    return rlist->rinfo[rindx].length;
+}
+
 /** Gets the type precision associated with a register */
 regtypeinfo reginfolist_typeinfo(reginfolist *rlist, int rindx) {
     if (rindx>=rlist->nreg) return REGTYPE_UNKNOWN;
@@ -7,6 +7,8 @@
 #ifndef reginfo_h
 #define reginfo_h
 
+#include <limits.h>
+
 #include "morphocore.h"
 
 /* **********************************************************************
@@ -38,6 +40,11 @@ typedef enum {
     REGTYPE_SUBTYPE /** Register has this type or a child type */
 } regtypeinfo;
 
+#define REGLENGTH_UNKNOWN -1
+
+#define REGRANGE_MIN INT_MIN /** Lower bound of an unbounded range */
+#define REGRANGE_MAX INT_MAX /** Upper bound of an unbounded range */
+
 /** Record information about each register */
 typedef struct {
     regcontents contents; /** Semantic knowledge about the value */
@@ -49,6 +56,10 @@ typedef struct {
     value type; /** Type information if known */
     regtypeinfo typeinfo; /** Precision of type information */
 
+    int length; /** Element count of a list or tuple if known, otherwise REGLENGTH_UNKNOWN */
+    int lo; /** Inclusive lower bound of an Int value, or REGRANGE_MIN */
+    int hi; /** Inclusive upper bound of an Int value, or REGRANGE_MAX */
+
     bool hasalias; /** True if this fact is currently known to alias another register */
     registerindx alias; /** Register that this fact currently aliases */
 } reginfo;
@@ -58,10 +69,15 @@ typedef struct {
     reginfo *rinfo;
 } reginfolist;
 
+/** Index of class relationships used when joining types; see info.h */
+typedef struct classhierarchy classhierarchy;
+
 /* **********************************************************************
  * Interface
  * ********************************************************************** */
 
+void reginfo_setclasshierarchy(classhierarchy *hierarchy);
+
 void reginfolist_init(reginfolist *rlist, int nreg);
 void reginfolist_clear(reginfolist *rlist);
 void reginfolist_wipe(reginfolist *rlist, int nreg);
@@ -78,7 +94,13 @@ void reginfolist_settypeinfo(reginfolist *rlist, int rindx, value type, regtypei
 void reginfolist_incread(reginfolist *rlist, int rindx);
 void reginfolist_incwrite(reginfolist *rlist, int rindx);
 
+void reginfolist_setlength(reginfolist *rlist, int rindx, int length);
+void reginfolist_invalidatelengths(reginfolist *rlist, value immutabletype);
+void reginfolist_setrange(reginfolist *rlist, int rindx, int lo, int hi);
+bool reginfolist_range(reginfolist *rlist, int rindx, int *lo, int *hi);
+
 value reginfolist_type(reginfolist *rlist, int rindx);
+int reginfolist_length(reginfolist *rlist, int rindx);
 regtypeinfo reginfolist_typeinfo(reginfolist *rlist, int rindx);
 bool reginfolist_contents(reginfolist *rlist, int rindx, regcontents *contents, indx *indx);
 regcontents reginfolist_regcontents(reginfolist *rlist, int rindx);
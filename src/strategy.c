@@ -17,6 +17,13 @@
 #define CHECK(f) if (!(f)) return false;
 
 #define STRATEGY_INLINE_MAXINSTRUCTIONS 12
+#define STRATEGY_INLINE_MAXBLOCKS 8
+#define STRATEGY_INLINE_LOOPBONUS 12
+#define STRATEGY_INLINE_ARGBONUS 4
+#define STRATEGY_ROTATE_MAXINSTRUCTIONS 8
+#define STRATEGY_CLONE_MAXINSTRUCTIONS 64
+#define STRATEGY_UNROLL_MAXINSTRUCTIONS 48
+#define STRATEGY_UNROLL_FACTOR 4
 
 /* -------------------------------------
  * Reduce power to multiplication
@@ -91,22 +98,23 @@ bool strategy_constant_folding(optimizer *opt) {
     
     CHECK(op>=OP_ADD && op<=OP_LE); // Quickly eliminate non-arithmetic instructions
     
-    indx left, right; // Check both operands are constants
-    CHECK(optimize_findconstant(opt, DECODE_B(instr), &left) &&
-          optimize_findconstant(opt, DECODE_C(instr), &right));
-        
-    // A program that evaluates the required op with the selected constants.
-    instruction ilist[] = {
-        ENCODE_LONG(OP_LCT, 0, (instruction) left),
-        ENCODE_LONG(OP_LCT, 1, (instruction) right),
-        ENCODE(op, 0, 0, 1),
-        ENCODE_BYTE(OP_END)
-    };
+    indx left, right; // Check both operands are constants; not only has one
+    CHECK(optimize_findconstant(opt, DECODE_B(instr), &left));
+    if (op==OP_NOT) right=left;
+    else CHECK(optimize_findconstant(opt, DECODE_C(instr), &right));
     
-    // Evaluate the program
+    // Common cases are folded directly
     value new = MORPHO_NIL;
-    if (!optimize_evalsubprogram(opt, ilist, 0, &new)) {
-        return false;
+    if (!optimize_evalnative(op, optimize_getconstant(opt, left), optimize_getconstant(opt, right), &new)) {
+        // Otherwise, a program that evaluates the required op with the selected constants.
+        instruction ilist[] = {
+            ENCODE_LONG(OP_LCT, 0, (instruction) left),
+            ENCODE_LONG(OP_LCT, 1, (instruction) right),
+            ENCODE(op, 0, 0, 1),
+            ENCODE_BYTE(OP_END)
+        };
+        
+        if (!optimize_evalsubprogram(opt, ilist, 0, &new)) return false;
     }
     
     // Replace result with an appropriate LCT
@@ -118,6 +126,67 @@ bool strategy_constant_folding(optimizer *opt) {
     return true;
 }
 
+/** Folds cat of constant Strings and Ints */
+bool strategy_constant_cat(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    registerindx b = DECODE_B(instr), c = DECODE_C(instr);
+    
+    CHECK(c>=b);
+    value operands[c-b+1];
+    for (registerindx r=b; r<=c; r++) {
+        indx kindx;
+        CHECK(optimize_findconstant(opt, r, &kindx));
+        operands[r-b] = optimize_getconstant(opt, kindx);
+    }
+    
+    value new = MORPHO_NIL;
+    CHECK(optimize_evalcat(c-b+1, operands, &new));
+    
+    if (!optimize_replacewithloadconstant(opt, DECODE_A(instr), new)) {
+        morpho_freeobject(new);
+        return false;
+    }
+    
+    return true;
+}
+
+/* -------------------------------------
+ * Range comparison folding
+ * ------------------------------------- */
+
+/** Folds an Int comparison whose outcome is decided by the ranges of its operands */
+bool strategy_range_comparison(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    instruction op = DECODE_OP(instr);
+    int bl, bh, cl, ch;
+
+    CHECK(optimize_intrange(opt, DECODE_B(instr), &bl, &bh) &&
+          optimize_intrange(opt, DECODE_C(instr), &cl, &ch));
+
+    bool result;
+    if (op==OP_LT && bh!=REGRANGE_MAX && cl!=REGRANGE_MIN && bh<cl) result=true;
+    else if (op==OP_LT && bl!=REGRANGE_MIN && ch!=REGRANGE_MAX && bl>=ch) result=false;
+    else if (op==OP_LE && bh!=REGRANGE_MAX && cl!=REGRANGE_MIN && bh<=cl) result=true;
+    else if (op==OP_LE && bl!=REGRANGE_MIN && ch!=REGRANGE_MAX && bl>ch) result=false;
+    else return false;
+
+    return optimize_replacewithloadconstant(opt, DECODE_A(instr), MORPHO_BOOL(result));
+}
+
+/* -------------------------------------
+ * Redundant type checks
+ * ------------------------------------- */
+
+/** Deletes a type check on a register whose type facts already prove it satisfies the checked class */
+bool strategy_redundant_typecheck(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+
+    CHECK(optimize_satisfiestype(opt, DECODE_A(instr), optimize_getconstant(opt, DECODE_Bx(instr))));
+
+    optimize_replaceinstruction(opt, ENCODE_BYTE(OP_NOP));
+    return true;
+}
+
 /* -------------------------------------
  * Algebraic identities
  * ------------------------------------- */
@@ -396,6 +465,221 @@ bool strategy_redundant_branch_elimination(optimizer *opt) {
     return true;
 }
 
+/* -------------------------------------
+ * Loop rotation
+ * ------------------------------------- */
+
+/** Checks whether a loop header is a short test block that can be duplicated at the latch */
+static bool _isrotatableheader(optimizer *opt, block *header, int *ninstr) {
+    int n=0;
+
+    for (instructionindx i=header->start; i<header->end; i++) {
+        instruction op = DECODE_OP(optimize_getinstructionat(opt, i));
+        opcodeflags flags = opcode_getflags(op);
+
+        if (op==OP_NOP) continue;
+        if (op>=OP_INSERT ||
+            (flags & (OPCODE_BRANCH | OPCODE_BRANCH_TABLE | OPCODE_TERMINATING | OPCODE_ENDSBLOCK))) return false;
+        n++;
+    }
+
+    *ninstr = n;
+    return (n<=STRATEGY_ROTATE_MAXINSTRUCTIONS);
+}
+
+/** Rewrites the back edge `b header` of a while-style loop into a copy of the header test
+    branching directly to the body, so that each iteration executes one branch instead of two */
+bool strategy_loop_rotation(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    block *latch = optimize_currentblock(opt), *header, *body, *exit;
+    blockindx latchindx, headerindx, bodyindx, exitindx;
+    int n;
+
+    CHECK(DECODE_OP(instr)==OP_B && optimize_getinstructionindx(opt)==latch->end);
+    CHECK(cfgraph_findindx(&opt->graph, latch, &latchindx));
+    CHECK(cfgraph_findblockindx(&opt->graph, latch->end+1+DECODE_sBx(instr), &headerindx) &&
+          headerindx!=latchindx &&
+          cfgraph_indx(&opt->graph, headerindx, &header));
+    CHECK(header->func==latch->func &&
+          dictionary_get(&header->loopsrc, MORPHO_INTEGER(latchindx), NULL));
+
+    // The header must end with a conditional exit to the instruction following the latch
+    instruction test = optimize_getinstructionat(opt, header->end);
+    instruction testop = DECODE_OP(test);
+    CHECK(testop==OP_BIF || testop==OP_BIFF);
+    CHECK(header->end+1+DECODE_sBx(test)==latch->end+1);
+    CHECK(cfgraph_findblockindx(&opt->graph, latch->end+1, &exitindx) &&
+          header->branch==exitindx);
+    CHECK(cfgraph_findblockindx(&opt->graph, header->end+1, &bodyindx) &&
+          header->fallthrough==bodyindx);
+    CHECK(_isrotatableheader(opt, header, &n));
+
+    instruction insert[n+1];
+    int k=0;
+    for (instructionindx i=header->start; i<header->end; i++) {
+        instruction hinstr = optimize_getinstructionat(opt, i);
+        if (DECODE_OP(hinstr)!=OP_NOP) insert[k++]=hinstr;
+    }
+
+    /* The inverted test lands at latch->end+n once the insertion is expanded; it
+       continues the loop by branching back to the body and falls through to the exit. */
+    CHECK(cfgraph_indx(&opt->graph, bodyindx, &body) &&
+          cfgraph_indx(&opt->graph, exitindx, &exit));
+    instructionindx offset = body->start - (latch->end + n) - 1;
+    insert[n] = ENCODE_LONG((testop==OP_BIF ? OP_BIFF : OP_BIF), DECODE_A(test), offset);
+
+    cfgraph_disconnect(latch, headerindx, &opt->graph);
+    cfgraph_connect(latch, bodyindx, body->start, &opt->graph);
+    cfgraph_connect(latch, exitindx, exit->start, &opt->graph);
+    latch->branch=bodyindx;
+    latch->fallthrough=exitindx;
+    opt->reachabledirty=true;
+
+    optimize_insertinstructions(opt, n+1, insert);
+    return true;
+}
+
+/* -------------------------------------
+ * Loop unrolling
+ * ------------------------------------- */
+
+/** Finds the integer constant held by register r just before instruction at in a single-block loop */
+static bool _loopintconstant(optimizer *opt, block *blk, instructionindx at, registerindx r, int *out) {
+    regcontents contents;
+    indx kindx;
+    value konst = MORPHO_NIL;
+    bool found=false;
+
+    for (instructionindx i=blk->start; i<=blk->end; i++) {
+        instruction instr = optimize_getinstructionat(opt, i);
+        registerindx w;
+        if (!opcode_overwritesforinstruction(instr, &w) || w!=r) continue;
+
+        // Writes after this point would be loop-carried into the next iteration
+        if (i>=at || DECODE_OP(instr)!=OP_LCT) return false;
+        konst = optimize_getconstant(opt, DECODE_Bx(instr));
+        found=true;
+    }
+
+    if (!found) {
+        if (!reginfolist_contents(&blk->rin, r, &contents, &kindx) || contents!=REG_CONSTANT) return false;
+        konst = optimize_getconstant(opt, kindx);
+    }
+
+    if (!MORPHO_ISINTEGER(konst)) return false;
+    *out = MORPHO_GETINTEGERVALUE(konst);
+    return true;
+}
+
+/** Finds the unique predecessor of a self-loop that enters it from outside */
+static bool _loopentrypred(optimizer *opt, block *blk, blockindx blkindx, block **out) {
+    int nentry=0;
+
+    if (blk->src.count!=2) return false;
+    for (int i=0; i<blk->src.capacity; i++) {
+        value key = blk->src.contents[i].key;
+        if (!MORPHO_ISINTEGER(key) || MORPHO_GETINTEGERVALUE(key)==blkindx) continue;
+        if (!cfgraph_indx(&opt->graph, (blockindx) MORPHO_GETINTEGERVALUE(key), out)) return false;
+        nentry++;
+    }
+
+    return (nentry==1);
+}
+
+/** Identifies the single update `add ri, ri, rk` of the induction register and its stride */
+static bool _loopinductionstride(optimizer *opt, block *blk, registerindx ri, int *stride) {
+    instructionindx update=INSTRUCTIONINDX_EMPTY;
+
+    for (instructionindx i=blk->start; i<blk->end-1; i++) {
+        instruction instr = optimize_getinstructionat(opt, i);
+        registerindx w;
+        if (!opcode_overwritesforinstruction(instr, &w) || w!=ri) continue;
+        if (update!=INSTRUCTIONINDX_EMPTY ||
+            DECODE_OP(instr)!=OP_ADD || DECODE_B(instr)!=ri) return false;
+        update=i;
+    }
+
+    if (update==INSTRUCTIONINDX_EMPTY) return false;
+    return _loopintconstant(opt, blk, update, DECODE_C(optimize_getinstructionat(opt, update)), stride);
+}
+
+/** Unrolls a rotated single-block loop `body; add ri, ri, k; lt/le rc, ri, rn; bif rc` with constant
+    bounds: fully when the trip count fits the growth budget, otherwise by STRATEGY_UNROLL_FACTOR when
+    it divides the trip count. Intermediate compares are dropped since only the final one is branched on. */
+bool strategy_loop_unrolling(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    block *blk = optimize_currentblock(opt), *entry;
+    blockindx blkindx;
+    int i0, n, k, trip, m=0;
+
+    CHECK(DECODE_OP(instr)==OP_BIF && optimize_getinstructionindx(opt)==blk->end && blk->end-blk->start>=2);
+    CHECK(cfgraph_findindx(&opt->graph, blk, &blkindx) && blk->branch==blkindx);
+    CHECK(blk->end+1+DECODE_sBx(instr)==blk->start);
+
+    instruction cmp = optimize_getinstructionat(opt, blk->end-1);
+    registerindx rc = DECODE_A(cmp), ri = DECODE_B(cmp);
+    CHECK((DECODE_OP(cmp)==OP_LT || DECODE_OP(cmp)==OP_LE) && rc==DECODE_A(instr) && rc!=ri);
+
+    CHECK(_loopentrypred(opt, blk, blkindx, &entry));
+    CHECK(_loopinductionstride(opt, blk, ri, &k) && k>0);
+    CHECK(_loopintconstant(opt, blk, blk->end-1, DECODE_C(cmp), &n));
+
+    regcontents contents;
+    indx kindx;
+    CHECK(reginfolist_contents(&entry->rout, ri, &contents, &kindx) && contents==REG_CONSTANT);
+    value start = optimize_getconstant(opt, kindx);
+    CHECK(MORPHO_ISINTEGER(start));
+    i0 = MORPHO_GETINTEGERVALUE(start);
+
+    long long span = (long long) n - i0, ltrip; // Bounds far apart overflow an int
+    if (DECODE_OP(cmp)==OP_LT) ltrip = (span>0 ? (span + k - 1)/k : 0);
+    else ltrip = (span>=0 ? span/k + 1 : 0);
+    CHECK(ltrip>0 && ltrip<=INT_MAX);
+    trip = (int) ltrip;
+
+    // The compare result must be private to the loop test
+    for (instructionindx i=blk->start; i<blk->end-1; i++) {
+        instruction binstr = optimize_getinstructionat(opt, i);
+        instruction op = DECODE_OP(binstr);
+        _strategyusedregister used = { .target = rc, .used = false };
+        opcode_usageforinstruction(blk, binstr, _strategy_findusedregister, &used);
+        CHECK(!used.used && op<OP_INSERT && !(opcode_getflags(op) & (OPCODE_ENDSBLOCK | OPCODE_BRANCH_TABLE)));
+        if (op!=OP_NOP) m++;
+    }
+    CHECK(m>0 && !optimize_checkdestusage(opt, blk, rc));
+
+    bool full = (trip-1<=STRATEGY_UNROLL_MAXINSTRUCTIONS/m);
+    int ncopies = (full ? trip-1 : STRATEGY_UNROLL_FACTOR-1);
+    CHECK(full || (trip%STRATEGY_UNROLL_FACTOR==0 && ncopies<=STRATEGY_UNROLL_MAXINSTRUCTIONS/m));
+
+    int ninsert = ncopies*m + (full ? 0 : 2);
+    instruction insert[ninsert > 0 ? ninsert : 1];
+    int j=0;
+    for (int c=0; c<ncopies; c++) {
+        for (instructionindx i=blk->start; i<blk->end-1; i++) {
+            instruction bodyinstr = optimize_getinstructionat(opt, i);
+            if (DECODE_OP(bodyinstr)!=OP_NOP) insert[j++]=bodyinstr;
+        }
+    }
+
+    optimize_replaceinstructionat(opt, blk->end-1, ENCODE_BYTE(OP_NOP));
+
+    if (full) {
+        optimize_repairerasedconditionalbranch(opt, instr);
+        if (ninsert==0) {
+            optimize_replaceinstruction(opt, ENCODE_BYTE(OP_NOP));
+            return true;
+        }
+    } else {
+        // The retained test lands at the end of the expanded block and branches back to its start
+        insert[j++]=cmp;
+        insert[j++]=ENCODE_LONG(OP_BIF, rc, blk->start - (blk->end + ninsert - 1) - 1);
+    }
+
+    optimize_insertinstructions(opt, ninsert, insert);
+    return true;
+}
+
 /* -------------------------------------
  * Constant Immutable Constructor
  * ------------------------------------- */
@@ -410,14 +694,19 @@ bool _isfoldsafeconstructortype(value v) {
             MORPHO_ISEQUAL(v, typefloat));
 }
 
-static bool _israngeenumerate(value fn, value recvtype) {
-    if (!MORPHO_ISEQUAL(recvtype, typerange) || !MORPHO_ISBUILTINFUNCTION(fn)) return false;
+/** Checks whether a callable is the builtin enumerate method used by for...in */
+static bool _isenumerate(value fn) {
+    if (!MORPHO_ISBUILTINFUNCTION(fn)) return false;
 
     objectbuiltinfunction *builtin = MORPHO_GETBUILTINFUNCTION(fn);
     return (MORPHO_ISSTRING(builtin->name) &&
             strcmp(MORPHO_GETCSTRING(builtin->name), "enumerate")==0);
 }
 
+static bool _israngeenumerate(value fn, value recvtype) {
+    return (MORPHO_ISEQUAL(recvtype, typerange) && _isenumerate(fn));
+}
+
 /* Restrict constant method folding to builtin methods that are pure and return immutable values.
    Range.enumerate currently lacks a return annotation, but its result is guaranteed immutable. */
 static bool _isfoldsafeconstantmethod(value fn, value recvtype) {
@@ -606,16 +895,139 @@ static bool _strategy_inlineinstruction(optimizer *opt, bool ismethod, objectfun
     }
 }
 
+/** Cost model: the instruction budget for inlining at this call site grows with the loop depth of
+    the call and with each argument whose constant or exact type will fold in the inlined body */
+static int _strategy_inlinebudget(optimizer *opt, bool ismethod, registerindx rA, int nargs) {
+    block *blk = optimize_currentblock(opt);
+    int budget = STRATEGY_INLINE_MAXINSTRUCTIONS;
+    blockindx bindx;
+    indx kindx;
+
+    if (cfgraph_findindx(&opt->graph, blk, &bindx)) {
+        for (int i=0; i<opt->graph.count; i++) {
+            block *header = &opt->graph.data[i];
+            if (header->func==blk->func &&
+                block_isloopheader(header) &&
+                block_inloop(header, bindx)) budget+=STRATEGY_INLINE_LOOPBONUS;
+        }
+    }
+
+    for (int i=0; i<nargs; i++) {
+        registerindx r = rA + i + (ismethod ? 2 : 1);
+        if (optimize_isconstant(opt, r, &kindx) ||
+            optimize_hasexacttype(opt, r)) budget+=STRATEGY_INLINE_ARGBONUS;
+    }
+
+    return budget;
+}
+
+static bool _strategy_inlineallowed(instruction op) {
+    return !(op==OP_END || op==OP_LUP || op==OP_SUP || op==OP_CLOSURE || op==OP_CLOSEUP ||
+             op==OP_PUSHERR || op==OP_POPERR || op>=OP_INSERT);
+}
+
+/** Collects the reachable blocks of a callee in layout order, checking they can be copied as a unit */
+static bool _strategy_inlinecollectblocks(optimizer *opt, objectfunction *callee, block **blocks, int *nblocks) {
+    int n=0;
+
+    for (int i=0; i<opt->graph.count; i++) {
+        block *blk = &opt->graph.data[i];
+        if (blk->func!=callee || !optimize_blockisreachable(opt, blk)) continue;
+        if (n>=STRATEGY_INLINE_MAXBLOCKS) return false;
+        blocks[n++]=blk;
+    }
+
+    if (n==0 || blocks[0]->start!=callee->entry) return false;
+
+    for (int j=0; j<n; j++) {
+        for (instructionindx i=blocks[j]->start; i<=blocks[j]->end; i++) {
+            instruction op = DECODE_OP(optimize_getinstructionat(opt, i));
+            if (!_strategy_inlineallowed(op) ||
+                (opcode_getflags(op) & OPCODE_BRANCH_TABLE)) return false;
+        }
+
+        // Blocks that fall through must remain adjacent once copied
+        instruction last = DECODE_OP(optimize_getinstructionat(opt, blocks[j]->end));
+        if (last==OP_B || last==OP_RETURN) continue;
+        if (j==n-1 || blocks[j+1]->start!=blocks[j]->end+1) return false;
+    }
+
+    *nblocks=n;
+    return true;
+}
+
+/** Copies a multi-block callee into a linear instruction sequence; each return becomes a move into
+    the result register followed by a branch to the continuation after the inlined code */
+static bool _strategy_inlineblocks(optimizer *opt, bool ismethod, objectfunction *callee, registerindx rA, int nargs, registerindx inlinebase, block **blocks, int nblocks, varray_instruction *insert) {
+    registerindx resultreg = (ismethod ? rA+1 : rA);
+    instructionindx base = blocks[0]->start, range = blocks[nblocks-1]->end - base + 1;
+    instructionindx newpos[range];
+    varray_instructionindx fixups; // Pairs of (emitted branch position, original target)
+    bool success=false;
+
+    for (instructionindx i=0; i<range; i++) newpos[i]=INSTRUCTIONINDX_EMPTY;
+    varray_instructionindxinit(&fixups);
+
+    for (int j=0; j<nblocks; j++) {
+        for (instructionindx i=blocks[j]->start; i<=blocks[j]->end; i++) {
+            instruction cinstr = optimize_getinstructionat(opt, i);
+            instruction op = DECODE_OP(cinstr), remapped;
+            registerindx a = DECODE_A(cinstr);
+
+            newpos[i-base]=insert->count;
+
+            if (op==OP_NOP) continue;
+            if (op==OP_RETURN) {
+                bool sawreturn=false;
+                if (!_strategy_inlineinstruction(opt, ismethod, callee, rA, nargs, inlinebase, cinstr, resultreg, &sawreturn, &remapped)) goto cleanup;
+                if (DECODE_OP(remapped)!=OP_NOP) varray_instructionwrite(insert, remapped);
+                if (j==nblocks-1 && i==blocks[j]->end) continue; // Final return falls into the continuation
+
+                varray_instructionindxwrite(&fixups, insert->count);
+                varray_instructionindxwrite(&fixups, INSTRUCTIONINDX_EMPTY);
+                varray_instructionwrite(insert, ENCODE_LONG(OP_B, 0, 0));
+            } else if (op==OP_B || op==OP_BIF || op==OP_BIFF) {
+                if (op!=OP_B && !_strategy_inlineregister(opt, ismethod, rA, nargs, inlinebase, a, &a)) goto cleanup;
+
+                varray_instructionindxwrite(&fixups, insert->count);
+                varray_instructionindxwrite(&fixups, i+1+DECODE_sBx(cinstr));
+                varray_instructionwrite(insert, ENCODE_LONG(op, a, 0));
+            } else {
+                if (!_strategy_inlineinstruction(opt, ismethod, callee, rA, nargs, inlinebase, cinstr, resultreg, NULL, &remapped)) goto cleanup;
+                varray_instructionwrite(insert, remapped);
+            }
+        }
+    }
+
+    // Branch offsets are relative, so they hold wherever the sequence lands
+    for (int k=0; k<fixups.count; k+=2) {
+        instructionindx pos = fixups.data[k], target = fixups.data[k+1], newtarget;
+        instruction binstr = insert->data[pos];
+
+        if (target==INSTRUCTIONINDX_EMPTY) newtarget = insert->count;
+        else if (target>=base && target<base+range && newpos[target-base]!=INSTRUCTIONINDX_EMPTY) newtarget = newpos[target-base];
+        else goto cleanup;
+
+        insert->data[pos] = ENCODE_LONG(DECODE_OP(binstr), DECODE_A(binstr), newtarget-pos-1);
+    }
+
+    success=(insert->count>0);
+
+cleanup:
+    varray_instructionindxclear(&fixups);
+    return success;
+}
+
 bool strategy_inline_function(optimizer *opt) {
     instruction instr = optimize_getinstruction(opt);
     instruction callop = DECODE_OP(instr);
     bool ismethod = (callop==OP_METHOD);
     registerindx rA = DECODE_A(instr), inlinebase;
-    int nargs = DECODE_B(instr), nopt = DECODE_C(instr);
+    int nargs = DECODE_B(instr), nopt = DECODE_C(instr), nblocks;
     indx kindx;
     value calleeval;
     objectfunction *callee;
-    block *blk;
+    block *blocks[STRATEGY_INLINE_MAXBLOCKS];
     varray_instruction insert;
     bool sawreturn=false;
 
@@ -629,29 +1041,28 @@ bool strategy_inline_function(optimizer *opt) {
         nopt!=0 ||
         callee->nopt!=0 ||
         nargs!=callee->nargs ||
-        functioninfolist_countblocks(&opt->functioninfo, callee)!=1 ||
-        functioninfolist_countinstructions(&opt->functioninfo, callee)>STRATEGY_INLINE_MAXINSTRUCTIONS ||
-        !cfgraph_findblock(&opt->graph, callee->entry, &blk) ||
-        blk->func!=callee) return false;
-
-    for (instructionindx i=blk->start; i<=blk->end; i++) {
-        instruction op = DECODE_OP(optimize_getinstructionat(opt, i));
-        if (op==OP_END || op==OP_LUP || op==OP_SUP || op==OP_CLOSURE || op==OP_CLOSEUP) return false;
-    }
+        functioninfolist_countinstructions(&opt->functioninfo, callee)>_strategy_inlinebudget(opt, ismethod, rA, nargs) ||
+        !_strategy_inlinecollectblocks(opt, callee, blocks, &nblocks)) return false;
 
     if (!_strategy_inlinebase(opt, ismethod, rA, nargs, callee, &inlinebase)) return false;
 
     varray_instructioninit(&insert);
 
-    for (instructionindx i=blk->start; i<=blk->end; i++) {
-        instruction cinstr = optimize_getinstructionat(opt, i);
-        instruction remapped;
+    if (nblocks>1) {
+        if (!_strategy_inlineblocks(opt, ismethod, callee, rA, nargs, inlinebase, blocks, nblocks, &insert)) goto cleanup;
+    } else {
+        block *blk = blocks[0];
 
-        if (!_strategy_inlineinstruction(opt, ismethod, callee, rA, nargs, inlinebase, cinstr, ismethod ? rA+1 : rA, &sawreturn, &remapped)) goto cleanup;
-        varray_instructionwrite(&insert, remapped);
-    }
+        for (instructionindx i=blk->start; i<=blk->end; i++) {
+            instruction cinstr = optimize_getinstructionat(opt, i);
+            instruction remapped;
 
-    if (!sawreturn || insert.count==0) goto cleanup;
+            if (!_strategy_inlineinstruction(opt, ismethod, callee, rA, nargs, inlinebase, cinstr, ismethod ? rA+1 : rA, &sawreturn, &remapped)) goto cleanup;
+            varray_instructionwrite(&insert, remapped);
+        }
+
+        if (!sawreturn || insert.count==0) goto cleanup;
+    }
 
     optimize_insertinstructionswithrestart(opt, insert.count, insert.data, true);
     varray_instructionclear(&insert);
@@ -663,33 +1074,306 @@ cleanup:
 }
 
 /* -------------------------------------
- * Range enumerate reduction
+ * Function cloning
  * ------------------------------------- */
 
-static bool _isunitrangestep(objectrange *range) {
-    return (MORPHO_ISNIL(range->step) ||
-            (MORPHO_ISINTEGER(range->step) && MORPHO_GETINTEGERVALUE(range->step)==1) ||
-            (MORPHO_ISFLOAT(range->step) && MORPHO_GETFLOATVALUE(range->step)==1.0));
+/** Redirects a call to a specialized copy of the callee when this site knows more about the
+    arguments than the facts joined over every call site */
+bool strategy_function_cloning(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    registerindx rA = DECODE_A(instr);
+    int nargs = DECODE_B(instr), nopt = DECODE_C(instr);
+    objectfunction *callee, *clone;
+    indx kindx, newkindx;
+
+    CHECK(optimize_isconstant(opt, rA, &kindx));
+    value fn = optimize_getconstant(opt, kindx);
+    CHECK(MORPHO_ISFUNCTION(fn));
+
+    callee = MORPHO_GETFUNCTION(fn);
+    CHECK(callee!=optimize_currentblock(opt)->func && nopt==0 && nargs==callee->nargs);
+    CHECK(functioninfolist_countinstructions(&opt->functioninfo, callee)<=STRATEGY_CLONE_MAXINSTRUCTIONS);
+    CHECK(optimize_callsiteismoreprecise(opt, callee, rA+1, nargs));
+    CHECK(optimize_clonefunction(opt, callee, &clone));
+    CHECK(optimize_addconstant(opt, MORPHO_OBJECT(clone), &newkindx));
+
+    instruction insert[] = {
+        ENCODE_LONG(OP_LCT, rA, (instruction) newkindx),
+        instr
+    };
+    optimize_insertinstructions(opt, 2, insert);
+    return true;
 }
 
-static bool _uniquesourceblock(optimizer *opt, block *blk, block **out) {
-    if (blk->src.count!=1) return false;
+/* -------------------------------------
+ * Pure call reuse
+ * ------------------------------------- */
 
-    for (int i=0; i<blk->src.capacity; i++) {
-        value key = blk->src.contents[i].key;
-        if (MORPHO_ISINTEGER(key) &&
-            cfgraph_indx(&opt->graph, (blockindx) MORPHO_GETINTEGERVALUE(key), out)) return true;
+static bool _isimmutableresulttype(value type) {
+    return (MORPHO_ISEQUAL(type, typeint) ||
+            MORPHO_ISEQUAL(type, typefloat) ||
+            MORPHO_ISEQUAL(type, typebool));
+}
+
+/** Checks whether argument register reg of the current call holds the value that register prevreg held at the earlier call prev */
+static bool _strategy_samecallargument(optimizer *opt, block *blk, instructionindx prev, registerindx prevreg, registerindx reg) {
+    instructionindx src;
+    indx kindx;
+
+    CHECK(optimize_findwriter(opt, blk, prevreg, prev, &src));
+    instruction load = optimize_getinstructionat(opt, src);
+
+    if (DECODE_OP(load)==OP_LCT) {
+        return (optimize_isconstant(opt, reg, &kindx) && kindx==DECODE_Bx(load));
+    } else if (DECODE_OP(load)==OP_MOV) {
+        registerindx orig = DECODE_B(load);
+        return (optimize_findoriginalregister(opt, reg)==orig &&
+                !optimize_isoverwritten(opt, orig, src+1));
     }
 
     return false;
 }
 
-static bool _rangeenumerateindex(optimizer *opt, instruction instr, objectrange *range, registerindx *out) {
-    registerindx rA = DECODE_A(instr), receiver = rA+1, arg = rA+2, origarg;
-    block *src;
+/** Replaces a call to a pure callee with a copy of the result of an identical earlier call in the same block */
+bool strategy_pure_call_reuse(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    registerindx rA = DECODE_A(instr);
+    int nargs = DECODE_B(instr);
+    block *blk = optimize_currentblock(opt);
+    instructionindx pc = optimize_getinstructionindx(opt), src;
+    value callee, prevcallee;
+    indx kindx;
 
-    if (DECODE_B(instr)!=1 || DECODE_C(instr)!=0) return false;
-    if (!_uniquesourceblock(opt, opt->currentblk, &src)) return false;
+    CHECK(DECODE_C(instr)==0 && optimize_isconstant(opt, rA, &kindx));
+    callee = optimize_getconstant(opt, kindx);
+    CHECK(optimize_calleffect(opt, callee)==FUNCTIONEFFECT_PURE);
+
+    for (instructionindx i=pc-1; i>=blk->start; i--) {
+        instruction prev = optimize_getinstructionat(opt, i);
+        registerindx pA = DECODE_A(prev);
+
+        if (DECODE_OP(prev)!=OP_CALL || DECODE_B(prev)!=nargs || DECODE_C(prev)!=0) continue;
+        if (!optimize_calltarget(opt, blk, i, &prevcallee) || !MORPHO_ISSAME(prevcallee, callee)) continue;
+
+        // The earlier result must still be live in its register and of an immutable type
+        if (!optimize_findwriter(opt, blk, pA, pc, &src) || src!=i ||
+            !_isimmutableresulttype(optimize_type(opt, pA))) continue;
+
+        bool same=true;
+        for (int k=1; k<=nargs && same; k++) {
+            same=_strategy_samecallargument(opt, blk, i, pA+k, rA+k);
+        }
+        if (!same) continue;
+
+        optimize_replaceinstruction(opt, ENCODE_DOUBLE(OP_MOV, rA, pA));
+        return true;
+    }
+
+    return false;
+}
+
+/* -------------------------------------
+ * Scalar replacement of aggregates
+ * ------------------------------------- */
+
+#define STRATEGY_SCALAR_MAXELEMENTS 8
+
+/** Identifies a constant integer index held by register r at instruction iindx */
+static bool _strategy_constantindex(optimizer *opt, block *blk, instructionindx iindx, registerindx r, int *out) {
+    instructionindx src;
+    CHECK(optimize_findwriter(opt, blk, r, iindx, &src));
+
+    instruction load = optimize_getinstructionat(opt, src);
+    CHECK(DECODE_OP(load)==OP_LCT);
+
+    value k = optimize_getconstant(opt, DECODE_Bx(load));
+    CHECK(MORPHO_ISINTEGER(k));
+    *out = MORPHO_GETINTEGERVALUE(k);
+    return true;
+}
+
+/** Replaces a List or Tuple that is built and only read with constant indices in this block by the
+    registers that held its elements; lix/lixl become movs and the constructor call is removed */
+bool strategy_scalar_replacement(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    registerindx rA = DECODE_A(instr);
+    int nargs = DECODE_B(instr);
+    block *blk = optimize_currentblock(opt);
+    instructionindx pc = optimize_getinstructionindx(opt);
+    indx kindx;
+
+    CHECK(DECODE_C(instr)==0 && nargs<=STRATEGY_SCALAR_MAXELEMENTS &&
+          nargs!=1 && // A single argument may be a collection to convert
+          optimize_isconstant(opt, rA, &kindx));
+
+    value fn = optimize_getconstant(opt, kindx);
+    CHECK(MORPHO_ISBUILTINFUNCTION(fn) &&
+          (MORPHO_GETBUILTINFUNCTION(fn)->flags & MORPHO_FN_CONSTRUCTOR));
+
+    value type = signature_getreturntype(&MORPHO_GETBUILTINFUNCTION(fn)->sig);
+    CHECK(MORPHO_ISSAME(type, typelist) || MORPHO_ISSAME(type, typetuple));
+
+    // Collect the accesses, stopping where the object register is overwritten
+    instructionindx access[blk->end-pc+1];
+    instruction replacement[blk->end-pc+1];
+    int naccess=0;
+    bool killed=false;
+
+    for (instructionindx i=pc+1; i<=blk->end && !killed; i++) {
+        instruction use = optimize_getinstructionat(opt, i);
+        instruction op = DECODE_OP(use);
+        _strategyusedregister used = { .target = rA, .used = false };
+        registerindx overwrites, dest, ireg;
+        int k;
+
+        CHECK(op!=OP_INSERT && op!=OP_INSERT_RESTART);
+
+        opcode_usageforinstruction(blk, use, _strategy_findusedregister, &used);
+        if (used.used) {
+            if (op==OP_LIX && DECODE_A(use)==rA && DECODE_B(use)==DECODE_C(use)) {
+                dest = ireg = DECODE_B(use);
+            } else if (op==OP_LIXL && DECODE_B(use)==rA && DECODE_C(use)!=rA) {
+                dest = DECODE_A(use); ireg = DECODE_C(use);
+            } else return false; // Any other use lets the object escape
+
+            CHECK(_strategy_constantindex(opt, blk, i, ireg, &k) && k>=0 && k<nargs);
+            CHECK(!optimize_isclobberedbetween(opt, pc+1, i, rA+1+k));
+
+            access[naccess]=i;
+            replacement[naccess]=ENCODE_DOUBLE(OP_MOV, dest, rA+1+k);
+            naccess++;
+        }
+
+        if (opcode_overwritesforinstruction(use, &overwrites) && overwrites==rA) killed=true;
+    }
+
+    CHECK(naccess>0);
+    if (!killed) CHECK(!optimize_checkdestusage(opt, blk, rA)); // The object must not be live out of the block
+
+    for (int i=0; i<naccess; i++) optimize_replaceinstructionat(opt, access[i], replacement[i]);
+    optimize_replaceinstruction(opt, ENCODE_BYTE(OP_NOP));
+    return true;
+}
+
+/* -------------------------------------
+ * Duplicate index elimination
+ * ------------------------------------- */
+
+/** Instructions that can neither resize nor modify a list or tuple */
+/** Checks if a register is known to hold exactly a List or Tuple, whose indexing calls no user code */
+static bool _strategy_iscollection(optimizer *opt, registerindx r) {
+    value type = optimize_type(opt, r);
+    return (optimize_typeinfo(opt, r)==REGTYPE_EXACT &&
+            (MORPHO_ISEQUAL(type, typelist) || MORPHO_ISEQUAL(type, typetuple)));
+}
+
+/** Checks that the instruction at iindx can't modify a collection; an index access is safe only if the object
+    it indexes is still held at the current instruction and known to be a List or Tuple */
+static bool _strategy_preservescollections(optimizer *opt, instructionindx iindx) {
+    instruction instr = optimize_getinstructionat(opt, iindx);
+    registerindx obj;
+
+    switch (DECODE_OP(instr)) {
+        case OP_NOP: case OP_MOV: case OP_LCT: case OP_LGL: case OP_LUP:
+        case OP_NOT: case OP_EQ: case OP_NEQ:
+            return true;
+        case OP_LIX: case OP_LIXL:
+            obj = (DECODE_OP(instr)==OP_LIX ? DECODE_A(instr) : DECODE_B(instr));
+            return (_strategy_iscollection(opt, obj) &&
+                    !optimize_isclobberedbetween(opt, iindx+1, optimize_getinstructionindx(opt), obj));
+        default:
+            return false;
+    }
+}
+
+/** Decodes a single-index lix or lixl into object, index and result registers */
+static bool _strategy_decodeindexaccess(instruction instr, registerindx *obj, registerindx *ix, registerindx *dest) {
+    if (DECODE_OP(instr)==OP_LIX && DECODE_B(instr)==DECODE_C(instr)) {
+        *obj=DECODE_A(instr); *ix=*dest=DECODE_B(instr);
+    } else if (DECODE_OP(instr)==OP_LIXL) {
+        *obj=DECODE_B(instr); *ix=DECODE_C(instr); *dest=DECODE_A(instr);
+    } else return false;
+    return true;
+}
+
+/** Replaces a repeated read of the same constant index of the same object with a copy of the earlier result */
+bool strategy_duplicate_index(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    registerindx obj, ix, dest;
+    block *blk = optimize_currentblock(opt);
+    instructionindx pc = optimize_getinstructionindx(opt), src;
+    indx kindx;
+
+    CHECK(_strategy_decodeindexaccess(instr, &obj, &ix, &dest) &&
+          optimize_isconstant(opt, ix, &kindx));
+    value k = optimize_getconstant(opt, kindx);
+    CHECK(MORPHO_ISINTEGER(k));
+    CHECK(_strategy_iscollection(opt, obj)); // Instances may run an index method with effects
+
+    for (instructionindx i=pc-1; i>=blk->start; i--) {
+        instruction prev = optimize_getinstructionat(opt, i);
+        registerindx pobj, pix, pdest;
+        int pk;
+
+        CHECK(_strategy_preservescollections(opt, i)); // Nothing between may modify the object
+        if (!_strategy_decodeindexaccess(prev, &pobj, &pix, &pdest) || pobj!=obj) continue;
+
+        if (optimize_isclobberedbetween(opt, i+1, pc, obj) ||
+            !_strategy_constantindex(opt, blk, i, pix, &pk) || pk!=MORPHO_GETINTEGERVALUE(k) ||
+            !optimize_findwriter(opt, blk, pdest, pc, &src) || src!=i) continue;
+
+        optimize_replaceinstruction(opt, ENCODE_DOUBLE(OP_MOV, dest, pdest));
+        return true;
+    }
+
+    return false;
+}
+
+/* -------------------------------------
+ * Duplicate property elimination
+ * ------------------------------------- */
+
+/** Replaces an lpr with a copy of the value still held from an earlier lpr or spr of the same label on the same object */
+bool strategy_duplicate_property(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    registerindx dest;
+
+    CHECK(optimize_findavailableproperty(opt, DECODE_B(instr), DECODE_C(instr), &dest));
+
+    if (dest==DECODE_A(instr)) optimize_replaceinstruction(opt, ENCODE_BYTE(OP_NOP));
+    else optimize_replaceinstruction(opt, ENCODE_DOUBLE(OP_MOV, DECODE_A(instr), dest));
+    return true;
+}
+
+/* -------------------------------------
+ * Store-to-load forwarding
+ * ------------------------------------- */
+
+/** Replaces a single-index lix or lixl of a List with a copy of the value a preceding six stored at the same index register */
+bool strategy_forward_index(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    registerindx obj, ix, dest, src;
+
+    CHECK(_strategy_decodeindexaccess(instr, &obj, &ix, &dest) &&
+          optimize_findavailableindex(opt, obj, ix, &src));
+
+    if (src==dest) optimize_replaceinstruction(opt, ENCODE_BYTE(OP_NOP));
+    else optimize_replaceinstruction(opt, ENCODE_DOUBLE(OP_MOV, dest, src));
+    return true;
+}
+
+/* -------------------------------------
+ * Range enumerate reduction
+ * ------------------------------------- */
+
+static bool _isunitrangestep(objectrange *range) {
+    return (MORPHO_ISNIL(range->step) ||
+            (MORPHO_ISINTEGER(range->step) && MORPHO_GETINTEGERVALUE(range->step)==1) ||
+            (MORPHO_ISFLOAT(range->step) && MORPHO_GETFLOATVALUE(range->step)==1.0));
+}
+
+/** Checks that a predecessor of the enumerate block ends in `lt rc, ri, rn; bif/biff rc` with ri the index and rn the range length */
+static bool _rangeloopsourcematches(optimizer *opt, block *src, registerindx origarg, objectrange *range) {
     if (src->end<=src->start) return false;
 
     instruction branch = optimize_getinstructionat(opt, src->end);
@@ -697,11 +1381,6 @@ static bool _rangeenumerateindex(optimizer *opt, instruction instr, objectrange
     if (DECODE_OP(cmp)!=OP_LT) return false;
     if (DECODE_OP(branch)!=OP_BIF && DECODE_OP(branch)!=OP_BIFF) return false;
     if (DECODE_A(branch)!=DECODE_A(cmp)) return false;
-
-    /* Earlier rewrites can collapse intermediate MOV chains before this reducer runs.
-       Follow aliases back to the original induction register instead of requiring a
-       direct alias on the enumerate argument copy. */
-    origarg = optimize_findoriginalregister(opt, arg);
     if (origarg!=DECODE_B(cmp)) return false;
 
     regcontents contents;
@@ -709,7 +1388,33 @@ static bool _rangeenumerateindex(optimizer *opt, instruction instr, objectrange
     if (!reginfolist_contents(&src->rout, DECODE_C(cmp), &contents, &kindx) || contents!=REG_CONSTANT) return false;
 
     value bound = optimize_getconstant(opt, kindx);
-    if (!MORPHO_ISINTEGER(bound) || MORPHO_GETINTEGERVALUE(bound)!=range->nsteps) return false;
+    return (MORPHO_ISINTEGER(bound) && MORPHO_GETINTEGERVALUE(bound)==range->nsteps);
+}
+
+static bool _rangeenumerateindex(optimizer *opt, instruction instr, objectrange *range, registerindx *out) {
+    registerindx rA = DECODE_A(instr), receiver = rA+1, arg = rA+2, origarg;
+    block *blk = opt->currentblk, *src;
+    int nsrc=0;
+
+    if (DECODE_B(instr)!=1 || DECODE_C(instr)!=0) return false;
+    if (blk->src.count<1) return false;
+
+    /* Earlier rewrites can collapse intermediate MOV chains before this reducer runs.
+       Follow aliases back to the original induction register instead of requiring a
+       direct alias on the enumerate argument copy. */
+    origarg = optimize_findoriginalregister(opt, arg);
+
+    /* A rotated loop reaches its body both from the guard and from the duplicated test
+       at the latch, so every predecessor must carry the same bounds check. */
+    for (int i=0; i<blk->src.capacity; i++) {
+        value key = blk->src.contents[i].key;
+        if (!MORPHO_ISINTEGER(key)) continue;
+        if (!cfgraph_indx(&opt->graph, (blockindx) MORPHO_GETINTEGERVALUE(key), &src) ||
+            !_rangeloopsourcematches(opt, src, origarg, range)) return false;
+        nsrc++;
+    }
+
+    if (nsrc==0) return false;
     if (!MORPHO_ISEQUAL(optimize_type(opt, receiver), typerange)) return false;
 
     *out = arg;
@@ -743,6 +1448,34 @@ bool strategy_range_reduction(optimizer *opt) {
     return true;
 }
 
+/* -------------------------------------
+ * List enumerate reduction
+ * ------------------------------------- */
+
+/** Lowers List.enumerate as called by for...in: fetching the element at a non-negative index
+    becomes lixl, and the count query with a negative index becomes a constant if the length is known */
+bool strategy_list_enumerate(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    registerindx rA = DECODE_A(instr), receiver = rA+1, arg = rA+2;
+    indx fnindx;
+    int lo, hi, length;
+
+    CHECK(DECODE_B(instr)==1 && DECODE_C(instr)==0);
+    CHECK(optimize_isconstant(opt, rA, &fnindx) && _isenumerate(optimize_getconstant(opt, fnindx)));
+    CHECK(optimize_typeinfo(opt, receiver)==REGTYPE_EXACT &&
+          MORPHO_ISEQUAL(optimize_type(opt, receiver), typelist));
+    CHECK(optimize_intrange(opt, arg, &lo, &hi));
+
+    if (lo>=0) {
+        optimize_replaceinstruction(opt, ENCODE(OP_LIXL, receiver, receiver, arg));
+        return true;
+    }
+
+    length = optimize_length(opt, receiver);
+    CHECK(hi<0 && length!=REGLENGTH_UNKNOWN);
+    return optimize_replacewithloadconstant(opt, receiver, MORPHO_INTEGER(length));
+}
+
 /* -------------------------------------
  * Constant global
  * ------------------------------------- */
@@ -780,6 +1513,444 @@ bool strategy_unused_global(optimizer *opt) {
     return success;
 }
 
+/* -------------------------------------
+ * Global promotion
+ * ------------------------------------- */
+
+#define STRATEGY_PROMOTE_MAXGLOBALS 8
+#define STRATEGY_PROMOTE_MAXEXITS 8
+
+typedef struct {
+    indx gindx[STRATEGY_PROMOTE_MAXGLOBALS];
+    bool written[STRATEGY_PROMOTE_MAXGLOBALS];
+    int nglobals;
+    blockindx exits[STRATEGY_PROMOTE_MAXEXITS];
+    int nexits;
+} _strategypromotion;
+
+/** Checks whether any function in the program establishes an error handler */
+static bool _programhastry(optimizer *opt) {
+    varray_instruction *code = &opt->prog->code;
+
+    for (instructionindx i=0; i<code->count; i++) {
+        if (DECODE_OP(code->data[i])==OP_PUSHERR) return true;
+    }
+    return false;
+}
+
+/** Finds the only destination of a block */
+static bool _singledest(block *blk, blockindx *out) {
+    if (blk->dest.count!=1) return false;
+    for (int i=0; i<blk->dest.capacity; i++) {
+        value key = blk->dest.contents[i].key;
+        if (!MORPHO_ISINTEGER(key)) continue;
+        *out = (blockindx) MORPHO_GETINTEGERVALUE(key);
+        return true;
+    }
+    return false;
+}
+
+static void _strategy_highestregister(registerindx r, void *ref) {
+    registerindx *highest = (registerindx *) ref;
+    if (r>*highest) *highest=r;
+}
+
+/** Returns the highest register any instruction of a function refers to */
+static registerindx _functionhighestregister(optimizer *opt, objectfunction *func) {
+    registerindx highest=0;
+
+    for (int i=0; i<opt->graph.count; i++) {
+        block *blk = &opt->graph.data[i];
+        if (blk->func!=func) continue;
+
+        for (instructionindx j=blk->start; j<=blk->end; j++) {
+            instruction instr = optimize_getinstructionat(opt, j);
+            registerindx w;
+            opcode_usageforinstruction(blk, instr, _strategy_highestregister, &highest);
+            if (opcode_overwritesforinstruction(instr, &w) && w>highest) highest=w;
+        }
+    }
+
+    return highest;
+}
+
+/** Loops may only observe globals through lgl and sgl: the only calls allowed are to pure builtins,
+    which neither touch globals nor take a register frame that could overlap the promoted registers */
+static bool _ispromotableinstruction(optimizer *opt, block *blk, instructionindx i) {
+    instruction op = DECODE_OP(optimize_getinstructionat(opt, i));
+    value callee;
+
+    if (op==OP_SGL) return true;
+    if (op==OP_CALL) return (optimize_calltarget(opt, blk, i, &callee) &&
+                             MORPHO_ISBUILTINFUNCTION(callee) &&
+                             optimize_calleffect(opt, callee)==FUNCTIONEFFECT_PURE);
+
+    return !(op>=OP_INSERT || op==OP_INVOKE || op==OP_METHOD ||
+             (opcode_getflags(op) & (OPCODE_IMPURE | OPCODE_TERMINATING | OPCODE_BRANCH_TABLE)));
+}
+
+/** Records a global accessed in the loop */
+static bool _promoteglobal(_strategypromotion *p, indx g, bool write) {
+    for (int k=0; k<p->nglobals; k++) {
+        if (p->gindx[k]!=g) continue;
+        p->written[k] |= write;
+        return true;
+    }
+    if (p->nglobals>=STRATEGY_PROMOTE_MAXGLOBALS) return false;
+
+    p->gindx[p->nglobals]=g;
+    p->written[p->nglobals]=write;
+    p->nglobals++;
+    return true;
+}
+
+/** Records an exit of the loop; exits must be entered only from within the loop */
+static bool _promoteexit(optimizer *opt, block *header, _strategypromotion *p, blockindx eindx) {
+    block *exit;
+
+    for (int k=0; k<p->nexits; k++) if (p->exits[k]==eindx) return true;
+    if (p->nexits>=STRATEGY_PROMOTE_MAXEXITS ||
+        !cfgraph_indx(&opt->graph, eindx, &exit) ||
+        exit->func!=header->func ||
+        !optimize_canprependinstructions(opt, exit)) return false;
+
+    for (int i=0; i<exit->src.capacity; i++) {
+        value key = exit->src.contents[i].key;
+        if (MORPHO_ISINTEGER(key) &&
+            !block_inloop(header, (blockindx) MORPHO_GETINTEGERVALUE(key))) return false;
+    }
+
+    p->exits[p->nexits++]=eindx;
+    return true;
+}
+
+/** Collects the globals and exits of a loop, checking that the loop can hold the globals in registers */
+static bool _promotableloop(optimizer *opt, block *header, _strategypromotion *p) {
+    p->nglobals=0;
+    p->nexits=0;
+
+    for (int i=0; i<header->loopblocks.capacity; i++) {
+        value key = header->loopblocks.contents[i].key;
+        block *blk;
+        if (!MORPHO_ISINTEGER(key)) continue;
+        if (!cfgraph_indx(&opt->graph, (blockindx) MORPHO_GETINTEGERVALUE(key), &blk) ||
+            blk->func!=header->func || block_hashandlers(blk)) return false;
+
+        for (instructionindx j=blk->start; j<=blk->end; j++) {
+            instruction instr = optimize_getinstructionat(opt, j);
+            instruction op = DECODE_OP(instr);
+            if (!_ispromotableinstruction(opt, blk, j)) return false;
+            if ((op==OP_LGL || op==OP_SGL) &&
+                !_promoteglobal(p, DECODE_Bx(instr), op==OP_SGL)) return false;
+        }
+
+        for (int k=0; k<blk->dest.capacity; k++) {
+            value dkey = blk->dest.contents[k].key;
+            if (!MORPHO_ISINTEGER(dkey)) continue;
+            blockindx dindx = (blockindx) MORPHO_GETINTEGERVALUE(dkey);
+            if (!block_inloop(header, dindx) && !_promoteexit(opt, header, p, dindx)) return false;
+        }
+    }
+
+    return (p->nglobals>0);
+}
+
+/** Keeps the globals a loop reads and writes in fresh registers: they are loaded at the end of the
+    preheader, lgl and sgl in the loop become moves and written globals are stored back on each exit */
+bool strategy_global_promotion(optimizer *opt) {
+    block *pre = optimize_currentblock(opt), *header;
+    objectfunction *func = pre->func;
+    blockindx preindx, headerindx;
+    _strategypromotion p;
+
+    CHECK(optimize_getinstructionindx(opt)==pre->end && _singledest(pre, &headerindx));
+    CHECK(cfgraph_findindx(&opt->graph, pre, &preindx) &&
+          cfgraph_indx(&opt->graph, headerindx, &header) &&
+          block_isloopheader(header) && header->func==func && header->start>pre->end);
+    CHECK(!block_inloop(header, preindx) && header->src.count==header->loopsrc.count+1);
+    CHECK(_promotableloop(opt, header, &p));
+
+    // Errors raised in the loop skip the stores, so they must not be catchable
+    CHECK(!block_hashandlers(pre) && (func==opt->prog->global || !_programhastry(opt)));
+
+    int base = _functionhighestregister(opt, func)+1;
+    if (base+p.nglobals>func->nregs) {
+        optimize_requirenregs(opt, func, base+p.nglobals);
+        return false;
+    }
+
+    for (int i=0; i<header->loopblocks.capacity; i++) {
+        value key = header->loopblocks.contents[i].key;
+        block *blk;
+        if (!MORPHO_ISINTEGER(key) ||
+            !cfgraph_indx(&opt->graph, (blockindx) MORPHO_GETINTEGERVALUE(key), &blk)) continue;
+
+        for (instructionindx j=blk->start; j<=blk->end; j++) {
+            instruction instr = optimize_getinstructionat(opt, j);
+            instruction op = DECODE_OP(instr);
+            if (op!=OP_LGL && op!=OP_SGL) continue;
+
+            registerindx rg = base;
+            while (p.gindx[rg-base]!=DECODE_Bx(instr)) rg++;
+            if (op==OP_LGL) optimize_replaceinstructionat(opt, j, ENCODE_DOUBLE(OP_MOV, DECODE_A(instr), rg));
+            else optimize_replaceinstructionat(opt, j, ENCODE_DOUBLE(OP_MOV, rg, DECODE_A(instr)));
+        }
+        block_computeusage(blk, opt->prog->code.data);
+    }
+
+    instruction stores[p.nglobals];
+    int nstores=0;
+    for (int k=0; k<p.nglobals; k++) {
+        if (p.written[k]) stores[nstores++]=ENCODE_LONG(OP_SGL, base+k, p.gindx[k]);
+    }
+
+    for (int k=0; k<p.nexits && nstores>0; k++) {
+        block *exit;
+        if (!cfgraph_indx(&opt->graph, p.exits[k], &exit) ||
+            !optimize_prependinstructions(opt, exit, nstores, stores)) {
+            optimize_error(opt, "OptimizerError", "Could not store promoted globals on loop exit.");
+            return false;
+        }
+    }
+
+    // Loads go before a branch that ends the preheader, otherwise after its last instruction
+    instruction last = optimize_getinstruction(opt);
+    instruction loads[p.nglobals+1];
+    bool before = (opcode_getflags(DECODE_OP(last)) & (OPCODE_BRANCH | OPCODE_ENDSBLOCK));
+    int n=0;
+
+    if (!before) loads[n++]=last;
+    for (int k=0; k<p.nglobals; k++) loads[n++]=ENCODE_LONG(OP_LGL, base+k, p.gindx[k]);
+    if (before) loads[n++]=last;
+
+    optimize_insertinstructions(opt, n, loads);
+    return true;
+}
+
+/* -------------------------------------
+ * Range loop lowering
+ * ------------------------------------- */
+
+#define STRATEGY_RANGELOOP_MAXSITES 8
+
+typedef struct {
+    blockindx blk;
+    instructionindx iindx;
+    registerindx rA;
+} _strategyrangesite;
+
+/** Checks whether a callable is a builtin that constructs a Range */
+static bool _israngeconstructor(value fn) {
+    return (MORPHO_ISBUILTINFUNCTION(fn) &&
+            MORPHO_ISEQUAL(signature_getreturntype(&MORPHO_GETBUILTINFUNCTION(fn)->sig), typerange));
+}
+
+/** Identifies `method rA, 1, 0` calling enumerate on a copy of a register, which is returned in rc */
+static bool _rangeloopsite(optimizer *opt, block *blk, instructionindx iindx, registerindx *rc) {
+    instruction instr = optimize_getinstructionat(opt, iindx);
+    registerindx rA = DECODE_A(instr);
+    instructionindx src;
+
+    CHECK(DECODE_OP(instr)==OP_METHOD && DECODE_B(instr)==1 && DECODE_C(instr)==0);
+
+    CHECK(optimize_findwriter(opt, blk, rA, iindx, &src));
+    instruction load = optimize_getinstructionat(opt, src);
+    CHECK(DECODE_OP(load)==OP_LCT && _isenumerate(optimize_getconstant(opt, DECODE_Bx(load))));
+
+    CHECK(optimize_findwriter(opt, blk, rA+1, iindx, &src));
+    instruction recv = optimize_getinstructionat(opt, src);
+    CHECK(DECODE_OP(recv)==OP_MOV && !optimize_isclobberedbetween(opt, src+1, iindx, DECODE_B(recv)));
+
+    *rc = DECODE_B(recv);
+    return true;
+}
+
+/** Checks that the argument of an enumerate site is a copy of the loop counter ri */
+static bool _rangeloopsiteindex(optimizer *opt, block *blk, instructionindx iindx, registerindx ri) {
+    registerindx arg = DECODE_A(optimize_getinstructionat(opt, iindx))+2;
+    instructionindx src;
+
+    CHECK(optimize_findwriter(opt, blk, arg, iindx, &src));
+    instruction mov = optimize_getinstructionat(opt, src);
+    return (DECODE_OP(mov)==OP_MOV && DECODE_B(mov)==ri &&
+            !optimize_isclobberedbetween(opt, src+1, iindx, ri));
+}
+
+/** Checks that register rc holds the Range constructed at pc when read at iindx */
+static bool _rangeloopholdsrange(optimizer *opt, block *blk, instructionindx pc, instructionindx iindx, registerindx rc) {
+    registerindx rR = DECODE_A(optimize_getinstructionat(opt, pc));
+    instructionindx src;
+
+    CHECK(optimize_findwriter(opt, blk, rc, iindx, &src));
+    if (src==pc) return (rc==rR);
+
+    instruction mov = optimize_getinstructionat(opt, src);
+    return (src>pc && DECODE_OP(mov)==OP_MOV && DECODE_B(mov)==rR &&
+            !optimize_isclobberedbetween(opt, pc+1, src, rR));
+}
+
+/** Checks whether register r is read or written by any instruction of a block in [start, end] */
+static bool _rangeloopregisterused(optimizer *opt, block *blk, instructionindx start, instructionindx end, registerindx r) {
+    for (instructionindx i=start; i<=end; i++) {
+        _strategyusedregister used = { .target = r, .used = false };
+        opcode_usageforinstruction(blk, optimize_getinstructionat(opt, i), _strategy_findusedregister, &used);
+        if (used.used) return true;
+    }
+    return optimize_isclobberedbetween(opt, start, end+1, r);
+}
+
+/** The loop counter ri may only be advanced by `add ri, ri, rk` with a positive constant rk */
+static bool _rangeloopcounterstep(optimizer *opt, block *blk, instructionindx iindx, registerindx ri) {
+    instruction instr = optimize_getinstructionat(opt, iindx);
+    int k;
+
+    if (!optimize_isclobberedbetween(opt, iindx, iindx+1, ri)) return true;
+    return (DECODE_OP(instr)==OP_ADD && DECODE_A(instr)==ri && DECODE_B(instr)==ri &&
+            _strategy_constantindex(opt, blk, iindx, DECODE_C(instr), &k) && k>0);
+}
+
+/** Collects the enumerate sites of a loop that read the Range in rc with the counter ri, checking
+    that rc is read nowhere else in the loop or after it, and that ri stays non-negative */
+static bool _rangeloopsites(optimizer *opt, block *header, registerindx rc, registerindx ri, _strategyrangesite *sites, int *nsites) {
+    int nuses=0;
+    *nsites=0;
+
+    for (int i=0; i<header->loopblocks.capacity; i++) {
+        value key = header->loopblocks.contents[i].key;
+        blockindx bindx;
+        block *blk;
+        if (!MORPHO_ISINTEGER(key)) continue;
+        bindx = (blockindx) MORPHO_GETINTEGERVALUE(key);
+        CHECK(cfgraph_indx(&opt->graph, bindx, &blk) && blk->func==header->func);
+        CHECK(!optimize_isclobberedbetween(opt, blk->start, blk->end+1, rc));
+
+        for (instructionindx j=blk->start; j<=blk->end; j++) {
+            instruction op = DECODE_OP(optimize_getinstructionat(opt, j));
+            registerindx src;
+
+            CHECK(op!=OP_INSERT && op!=OP_INSERT_RESTART);
+            CHECK(_rangeloopcounterstep(opt, blk, j, ri));
+            if (_rangeloopregisterused(opt, blk, j, j, rc)) nuses++;
+
+            if (!_rangeloopsite(opt, blk, j, &src) || src!=rc) continue;
+            CHECK(*nsites<STRATEGY_RANGELOOP_MAXSITES &&
+                  _rangeloopsiteindex(opt, blk, j, ri) &&
+                  optimize_canexpandat(opt, blk, j));
+
+            sites[*nsites].blk=bindx;
+            sites[*nsites].iindx=j;
+            sites[*nsites].rA=DECODE_A(optimize_getinstructionat(opt, j));
+            (*nsites)++;
+        }
+
+        for (int k=0; k<blk->dest.capacity; k++) {
+            value dkey = blk->dest.contents[k].key;
+            block *exit;
+            if (!MORPHO_ISINTEGER(dkey) ||
+                block_inloop(header, (blockindx) MORPHO_GETINTEGERVALUE(dkey))) continue;
+            CHECK(cfgraph_indx(&opt->graph, (blockindx) MORPHO_GETINTEGERVALUE(dkey), &exit));
+            CHECK(!block_uses(exit, rc) && (block_writes(exit, rc) || !optimize_checkdestusage(opt, exit, rc)));
+        }
+    }
+
+    // Each site reads rc once through the copy into its receiver
+    return (*nsites>0 && nuses==*nsites);
+}
+
+/** Lowers a for...in loop over a Range constructed at runtime with an Int start and constant step:
+    the register that held the Range keeps the start instead, and each element becomes start+i*step */
+bool strategy_range_loop_lowering(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    block *pre = optimize_currentblock(opt), *header;
+    instructionindx pc = optimize_getinstructionindx(opt), count=INSTRUCTIONINDX_EMPTY;
+    registerindx rR = DECODE_A(instr), rc=REGISTER_UNALLOCATED, ri, rs=REGISTER_UNALLOCATED;
+    int nargs = DECODE_B(instr), lo, hi, k, step=1, nsites;
+    blockindx preindx, headerindx;
+    indx kindx, kstart=0, kstep=0;
+    _strategyrangesite sites[STRATEGY_RANGELOOP_MAXSITES];
+
+    CHECK((nargs==2 || nargs==3) && DECODE_C(instr)==0);
+    CHECK(optimize_isconstant(opt, rR, &kindx) && _israngeconstructor(optimize_getconstant(opt, kindx)));
+    CHECK(optimize_intrange(opt, rR+1, &lo, &hi) && optimize_intrange(opt, rR+2, &lo, &hi));
+    if (nargs==3) {
+        CHECK(optimize_isconstant(opt, rR+3, &kstep));
+        value s = optimize_getconstant(opt, kstep);
+        CHECK(MORPHO_ISINTEGER(s) && MORPHO_GETINTEGERVALUE(s)!=0);
+        step = MORPHO_GETINTEGERVALUE(s);
+    }
+
+    // The count query made by for...in before entering the loop
+    for (instructionindx j=pc+1; j<=pre->end && count==INSTRUCTIONINDX_EMPTY; j++) {
+        if (_rangeloopsite(opt, pre, j, &rc) &&
+            _rangeloopholdsrange(opt, pre, pc, j, rc) &&
+            _strategy_constantindex(opt, pre, j, DECODE_A(optimize_getinstructionat(opt, j))+2, &k) && k<0) count=j;
+    }
+    CHECK(count!=INSTRUCTIONINDX_EMPTY && count<pre->end);
+    CHECK(!_rangeloopregisterused(opt, pre, count+1, pre->end, rc));
+
+    // The start must still be available once the count is known
+    if (!optimize_isconstant(opt, rR+1, &kstart)) {
+        rs = optimize_findoriginalregister(opt, rR+1);
+        CHECK(rs!=rR+1 && rs!=rc && !optimize_isclobberedbetween(opt, pc+1, count+1, rs));
+    }
+
+    CHECK(_singledest(pre, &headerindx));
+    CHECK(cfgraph_findindx(&opt->graph, pre, &preindx) &&
+          cfgraph_indx(&opt->graph, headerindx, &header) &&
+          block_isloopheader(header) && header->func==pre->func && header->start>pre->end);
+    CHECK(!block_inloop(header, preindx) && header->src.count==header->loopsrc.count+1);
+
+    // The header tests `lt rt, ri, rn; biff rt` and the counter starts from a non-negative constant
+    CHECK(header->end>header->start);
+    instruction branch = optimize_getinstructionat(opt, header->end);
+    instruction cmp = optimize_getinstructionat(opt, header->end-1);
+    CHECK((DECODE_OP(branch)==OP_BIF || DECODE_OP(branch)==OP_BIFF) &&
+          DECODE_OP(cmp)==OP_LT && DECODE_A(cmp)==DECODE_A(branch));
+    ri = DECODE_B(cmp);
+    CHECK(_strategy_constantindex(opt, pre, pre->end+1, ri, &k) && k>=0);
+
+    CHECK(_rangeloopsites(opt, header, rc, ri, sites, &nsites));
+
+    // Rewrite the sites from the last so that expanding one leaves the others in place
+    for (int i=1; i<nsites; i++) {
+        for (int j=i; j>0 && sites[j-1].iindx<sites[j].iindx; j--) {
+            _strategyrangesite tmp = sites[j]; sites[j]=sites[j-1]; sites[j-1]=tmp;
+        }
+    }
+
+    for (int i=0; i<nsites; i++) {
+        block *blk;
+        registerindx rA = sites[i].rA;
+        bool success = cfgraph_indx(&opt->graph, sites[i].blk, &blk);
+
+        if (success && step==1) {
+            optimize_replaceinstructionat(opt, sites[i].iindx, ENCODE(OP_ADD, rA+1, rA+2, rc));
+            block_computeusage(blk, opt->prog->code.data);
+        } else if (success) {
+            instruction element[] = {
+                ENCODE_LONG(OP_LCT, rA, (instruction) kstep),
+                ENCODE(OP_MUL, rA+1, rA+2, rA),
+                ENCODE(OP_ADD, rA+1, rA+1, rc)
+            };
+            success=optimize_insertinstructionsat(opt, blk, sites[i].iindx, 3, element);
+        }
+
+        if (!success) {
+            optimize_error(opt, "OptimizerError", "Could not lower Range loop.");
+            return false;
+        }
+    }
+
+    // Once the count is known, the register that held the Range holds the start
+    instruction counted[] = {
+        optimize_getinstructionat(opt, count),
+        (rs==REGISTER_UNALLOCATED ? ENCODE_LONG(OP_LCT, rc, (instruction) kstart) : ENCODE_DOUBLE(OP_MOV, rc, rs))
+    };
+    optimize_insertinstructionsafter(opt, count, 2, counted);
+    optimize_insertinstructions(opt, 1, &instr);
+    return true;
+}
+
 /* -------------------------------------
  * Load index list
  * ------------------------------------- */
@@ -803,33 +1974,15 @@ bool strategy_load_index_list(optimizer *opt) {
  * Method resolution
  * ------------------------------------- */
 
-static bool _strategy_subtreehasuniquemethod(objectclass *klass, value label, value expected) {
-    value candidate;
-
-    if (!morpho_lookupmethod(MORPHO_OBJECT(klass), label, &candidate)) return false;
-    if (!MORPHO_ISEQUAL(candidate, expected)) return false;
-
-    for (unsigned int i=0; i<klass->children.count; i++) {
-        value child = klass->children.data[i];
-        if (MORPHO_ISCLASS(child) &&
-            !_strategy_subtreehasuniquemethod(MORPHO_GETCLASS(child), label, expected)) return false;
-    }
-
-    return true;
-}
-
 static bool _strategy_lookupuniquemethod(optimizer *opt, registerindx receiver, value label, value *method) {
     value type = optimize_type(opt, receiver);
+    bool unique;
 
     if (!MORPHO_ISCLASS(type)) return false;
-    if (optimize_hasuniquetype(opt, receiver)) {
-        return morpho_lookupmethod(type, label, method);
-    }
-
-    if (optimize_typeinfo(opt, receiver)!=REGTYPE_SUBTYPE) return false;
-    if (!morpho_lookupmethod(type, label, method)) return false;
+    if (!optimize_lookupmethod(opt, type, label, method, &unique)) return false;
+    if (optimize_hasuniquetype(opt, receiver)) return true;
 
-    return _strategy_subtreehasuniquemethod(MORPHO_GETCLASS(type), label, *method);
+    return (optimize_typeinfo(opt, receiver)==REGTYPE_SUBTYPE && unique);
 }
 
 bool strategy_method_resolution(optimizer *opt) {
@@ -856,11 +2009,11 @@ bool strategy_method_resolution(optimizer *opt) {
             if (!MORPHO_ISCLASS(dispatchtarget)) return false;
 
             if (current && current->klass &&
-                optimize_classisderivedfrom(current->klass, MORPHO_GETCLASS(dispatchtarget))) {
+                optimize_classisderivedfrom(opt, current->klass, MORPHO_GETCLASS(dispatchtarget))) {
                 objectclass *dispatchklass = MORPHO_GETCLASS(dispatchtarget);
                 if (!(dispatchklass==current->klass && optimize_classisleaf(dispatchklass))) return false;
             }
-            if (!morpho_lookupmethod(dispatchtarget, label, &method)) return false;
+            if (!optimize_lookupmethod(opt, dispatchtarget, label, &method, NULL)) return false;
         } else {
             if (!_strategy_lookupuniquemethod(opt, receiver, label, &method)) return false;
         }
@@ -948,8 +2101,7 @@ bool strategy_metafunction_reduction(optimizer *opt) {
         types[i]=type;
     }
 
-    error reduceerr = opt->err;
-    if (metafunction_reduce(MORPHO_GETMETAFUNCTION(fn), nargs, types, &reduceerr, &newfn) &&
+    if (optimize_reducemetafunction(opt, fn, nargs, types, &newfn) &&
         !MORPHO_ISEQUAL(fn, newfn) &&
         optimize_addconstant(opt, newfn, &newkindx)) {
         if (opt->verbose) _printreducedsignature(newfn);
@@ -965,6 +2117,135 @@ bool strategy_metafunction_reduction(optimizer *opt) {
     return false;
 }
 
+/* -------------------------------------
+ * Tail recursion
+ * ------------------------------------- */
+
+/** Checks if a function can be re-entered by branching to its entry: it has plain positional parameters, never
+    writes r0 and neither captures registers nor handles errors */
+static bool _strategy_canreenter(optimizer *opt, objectfunction *func) {
+    value type;
+
+    if (func->klass || func->nopt!=0 || func==opt->prog->global) return false;
+    for (int i=0; i<func->nargs; i++) { // Parameter types are checked on call, not at entry
+        if (signature_getparamtype(&func->sig, i, &type) && !MORPHO_ISNIL(type)) return false;
+    }
+
+    for (int j=0; j<opt->graph.count; j++) {
+        block *blk = &opt->graph.data[j];
+        if (blk->func!=func) continue;
+
+        for (instructionindx i=blk->start; i<=blk->end; i++) {
+            instruction op = DECODE_OP(optimize_getinstructionat(opt, i));
+            if (op==OP_CLOSURE || op==OP_PUSHERR || op==OP_INSERT || op==OP_INSERT_RESTART ||
+                optimize_isclobberedbetween(opt, i, i+1, 0)) return false;
+        }
+    }
+
+    return true;
+}
+
+/** Checks if the call at iindx calls the function that contains it, either through its constant or through r0 */
+static bool _strategy_isselfcall(optimizer *opt, block *blk, instructionindx iindx) {
+    instructionindx src;
+    value callee;
+
+    if (optimize_calltarget(opt, blk, iindx, &callee)) {
+        return (MORPHO_ISFUNCTION(callee) && MORPHO_GETFUNCTION(callee)==blk->func && blk->func->nupvalues==0);
+    }
+
+    if (!optimize_findwriter(opt, blk, DECODE_A(optimize_getinstructionat(opt, iindx)), iindx, &src)) return false;
+    instruction load = optimize_getinstructionat(opt, src);
+    return (DECODE_OP(load)==OP_MOV && DECODE_B(load)==0);
+}
+
+/** Turns a self call whose result is returned directly into moves of its arguments onto the parameters and a branch to the function entry */
+bool strategy_tail_recursion(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    block *blk = optimize_currentblock(opt), *entry;
+    objectfunction *func = blk->func;
+    instructionindx rindx = optimize_getinstructionindx(opt), cindx;
+    blockindx entryindx;
+
+    CHECK(DECODE_A(instr)>0 && rindx==blk->end && !block_hashandlers(blk));
+
+    for (cindx=rindx-1; cindx>blk->start && DECODE_OP(optimize_getinstructionat(opt, cindx))==OP_NOP; cindx--);
+    instruction call = optimize_getinstructionat(opt, cindx);
+    registerindx a = DECODE_A(call);
+    int nargs = func->nargs;
+
+    // Arguments lie above the parameters, so the moves cannot overwrite a pending source
+    CHECK(cindx>=blk->start && cindx<rindx && DECODE_OP(call)==OP_CALL &&
+          a==DECODE_B(instr) && DECODE_B(call)==nargs && DECODE_C(call)==0 && a>=nargs);
+    CHECK(_strategy_canreenter(opt, func) && _strategy_isselfcall(opt, blk, cindx));
+    CHECK(cfgraph_findblockindx(&opt->graph, func->entry, &entryindx) &&
+          cfgraph_indx(&opt->graph, entryindx, &entry));
+
+    instruction insert[nargs+1];
+    for (int i=0; i<nargs; i++) insert[i]=ENCODE_DOUBLE(OP_MOV, i+1, a+1+i);
+    insert[nargs]=ENCODE_LONG(OP_B, 0, entry->start - (rindx+nargs) - 1); // The branch lands at rindx+nargs once expanded
+
+    optimize_replaceinstructionat(opt, cindx, ENCODE_BYTE(OP_NOP));
+    cfgraph_connect(blk, entryindx, entry->start, &opt->graph);
+    opt->reachabledirty=true;
+
+    optimize_insertinstructions(opt, nargs+1, insert);
+    return true;
+}
+
+/* -------------------------------------
+ * Closure demotion
+ * ------------------------------------- */
+
+/** Binds captured registers that always hold the same constant into the closure's function, and
+    replaces a closure that is left with nothing to capture by the plain function */
+bool strategy_closure_demotion(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+    objectfunction *func = opt->currentblk->func;
+    indx kindx;
+
+    CHECK(optimize_isconstant(opt, DECODE_A(instr), &kindx));
+    value fn = optimize_getconstant(opt, kindx);
+    CHECK(MORPHO_ISFUNCTION(fn));
+    objectfunction *inner = MORPHO_GETFUNCTION(fn);
+
+    varray_upvalue *prototype = &func->prototype.data[DECODE_B(instr)];
+    bool changed=false, bound=true;
+
+    for (unsigned int i=0; i<prototype->count; i++) {
+        upvalue *up = &prototype->data[i];
+        indx captured;
+
+        if (!up->islocal ||
+            !optimize_isconstant(opt, (registerindx) up->reg, &captured) ||
+            !optimize_isinvariantconstant(opt, func, (registerindx) up->reg, captured) ||
+            optimize_capturedbyother(opt, func, DECODE_B(instr), (registerindx) up->reg) || // A sibling could write it
+            optimize_writesupvalue(opt, inner, i)) {
+            bound=false;
+            continue;
+        }
+
+        if (optimize_bindupvalue(opt, inner, i, optimize_getconstant(opt, captured))>0) changed=true;
+    }
+
+    if (bound) {
+        optimize_replaceinstruction(opt, ENCODE_BYTE(OP_NOP));
+        changed=true;
+    }
+
+    return changed;
+}
+
+/** Deletes a closeup when no closure in the function captures a register that it would close */
+bool strategy_redundant_closeup(optimizer *opt) {
+    instruction instr = optimize_getinstruction(opt);
+
+    CHECK(!optimize_capturesfrom(opt, opt->currentblk->func, DECODE_A(instr)));
+
+    optimize_replaceinstruction(opt, ENCODE_BYTE(OP_NOP));
+    return true;
+}
+
 /* **********************************************************************
  * Strategy definition table
  * ********************************************************************** */
@@ -977,6 +2258,10 @@ optimizationstrategy strategies[] = {
     { OP_B,    strategy_redundant_branch_elimination,     0 },
     { OP_BIF,  strategy_constant_branch_elimination,      0 },
     { OP_BIFF, strategy_constant_branch_elimination,      0 },
+    { OP_CAT,  strategy_constant_cat,                     0 },
+    { OP_LT,   strategy_range_comparison,                 0 },
+    { OP_LE,   strategy_range_comparison,                 0 },
+    { OP_TYPECHECK, strategy_redundant_typecheck,         0 },
     { OP_ADD,  strategy_add_identity,                     0 },
     { OP_SUB,  strategy_sub_identity,                     0 },
     { OP_MUL,  strategy_mul_identity,                     0 },
@@ -986,21 +2271,37 @@ optimizationstrategy strategies[] = {
     { OP_LCT,  strategy_duplicate_load,                   0 },
     { OP_LGL,  strategy_duplicate_load,                   0 },
     { OP_LUP,  strategy_duplicate_load,                   0 },
+    { OP_LIX,  strategy_duplicate_index,                  0 },
+    { OP_LIXL, strategy_duplicate_index,                  0 },
     { OP_LIX,  strategy_load_index_list,                  0 },
+    { OP_LPR,  strategy_duplicate_property,               0 },
+    { OP_LIX,  strategy_forward_index,                    0 },
+    { OP_LIXL, strategy_forward_index,                    0 },
+    { OP_CALL, strategy_scalar_replacement,               0 },
     { OP_CALL, strategy_constant_immutable,               0 },
     { OP_CALL, strategy_inline_function,                  0 },
     { OP_METHOD, strategy_inline_function,                0 },
     { OP_METHOD, strategy_constant_method,                0 },
     { OP_INVOKE, strategy_method_resolution,              0 },
     { OP_METHOD, strategy_range_reduction,                0 },
+    { OP_METHOD, strategy_list_enumerate,                 0 },
     { OP_POW,  strategy_power_reduction,                  0 },
     { OP_CALL, strategy_self_dispatch,                    0 },
     { OP_METHOD, strategy_self_dispatch,                  0 },
     { OP_CALL, strategy_metafunction_reduction,           0 },
+    { OP_CALL, strategy_pure_call_reuse,                  0 },
     { OP_METHOD, strategy_metafunction_reduction,         0 },
+    { OP_CLOSURE, strategy_closure_demotion,              0 },
+    { OP_CLOSEUP, strategy_redundant_closeup,             0 },
     
     { OP_LGL,  strategy_constant_global,                  1 },
+    { OP_CALL, strategy_function_cloning,                 1 },
     { OP_SGL,  strategy_unused_global,                    1 },
+    { OP_B,    strategy_loop_rotation,                    1 },
+    { OP_BIF,  strategy_loop_unrolling,                   1 },
+    { OP_RETURN, strategy_tail_recursion,                 1 },
+    { OP_ANY,  strategy_global_promotion,                 1 },
+    { OP_CALL, strategy_range_loop_lowering,              1 },
     { OP_END,  NULL,                                      0 }
 };
 